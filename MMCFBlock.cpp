@@ -28,10 +28,26 @@
 
 #include "MMCFBlock.h"
 
+#include "Solver.h"
+
 //#include <math.h>
 
 #include <ctype.h>
 
+#include <cmath>
+
+#include <deque>
+
+#include <map>
+
+#include <numeric>
+
+#include <fcntl.h>
+
+#include <sys/mman.h>
+
+#include <unistd.h>
+
 /*--------------------------------------------------------------------------*/
 /*------------------------- NAMESPACE AND USING ----------------------------*/
 /*--------------------------------------------------------------------------*/
@@ -72,6 +88,69 @@ using Index = Block::Index;
 /*----------------------------- FUNCTIONS ----------------------------------*/
 /*--------------------------------------------------------------------------*/
 
+// move the rows of a matrix into (separate) SharedVector
+template< class T >
+static void to_shared( std::vector< SharedVector< T > > & to ,
+		       std::vector< std::vector< T > > && from )
+{
+ to.clear();
+ to.reserve( from.size() );
+ for( auto & row : from )
+  to.emplace_back( std::move( row ) );
+ }
+
+/*--------------------------------------------------------------------------*/
+// copy the rows of a matrix out of SharedVector
+
+template< class T >
+static std::vector< std::vector< T > > to_plain(
+			      const std::vector< SharedVector< T > > & from )
+{
+ return( std::vector< std::vector< T > >( from.begin() , from.end() ) );
+ }
+
+/*--------------------------------------------------------------------------*/
+// the elements of v in the (ordered) positions idx, or v itself if idx is
+// empty (which shares the data)
+
+template< class T >
+static SharedVector< T > gather( const SharedVector< T > & v ,
+				 const Block::Subset & idx )
+{
+ if( idx.empty() )
+  return( v );
+
+ std::vector< T > w( idx.size() );
+ for( Block::Index h = 0 ; h < idx.size() ; ++h )
+  w[ h ] = v[ idx[ h ] ];
+ return( SharedVector< T >( std::move( w ) ) );
+ }
+
+/*--------------------------------------------------------------------------*/
+// solve blk with its first registered Solver, and write the solution in its
+// Variable; false if there is no Solver or it does not find an optimum
+
+static bool solve_sub_Block( Block * blk )
+{
+ const auto & slvs = blk->get_registered_solvers();
+ if( slvs.empty() )
+  return( false );
+
+ // an exception can not leave an OpenMP parallel region, where this is
+ // called: a Solver throwing is a failure like any other
+ try {
+  auto slv = slvs.front();
+  if( slv->compute() != Solver::kOK )
+   return( false );
+
+  slv->get_var_solution();
+  }
+ catch( ... ) {
+  return( false );
+  }
+ return( true );
+ }
+
 /*--------------------------------------------------------------------------*/
 /*--------------------------- STATIC MEMBERS -------------------------------*/
 /*--------------------------------------------------------------------------*/
@@ -222,30 +301,30 @@ void MMCFBlock::load( const std::string & input , char frmt )
  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
  C.resize( NComm );  // allocate costs
- F.resize( NArcs );  // allocate fixed costs
+ F.mut().resize( NArcs );  // allocate fixed costs
 
  for( Index i = 0 ; i < NComm ; i++ )
-  C[ i ].resize( NArcs , Inf< CNumber >() );  // arcs are un-existent
+  C[ i ].mut().resize( NArcs , Inf< CNumber >() );  // arcs are un-existent
                                               // unless otherwise stated
 
  U.resize( NComm );  // allocate capacities - - - - - - - - - - - - -
 
  for( Index i = 0 ; i < NComm ; i++ )
-  U[ i ].resize( NArcs , 0 );  // arcs are un-existent
+  U[ i ].mut().resize( NArcs , 0 );  // arcs are un-existent
                                // unless otherwise stated
 
  B.resize( NComm );  // allocate deficits
 
  for( Index i = 0 ; i < NComm ; i++ )
-  B[ i ].resize( NNodes , 0 );    // nodes all have 0 deficit
+  B[ i ].mut().resize( NNodes , 0 );    // nodes all have 0 deficit
                                   // unless otherwise stated
 
  // allocate start/end nodes and mutual capacities- - - - - - - - - - - - - -
 
- Startn.resize( NArcs );
- Endn.resize( NArcs );
+ Startn.mut().resize( NArcs );
+ Endn.mut().resize( NArcs );
 
- UTot.resize( NArcs );
+ UTot.mut().resize( NArcs );
 
  // reading supply/demand infos, or everything in one-files format- - - - - -
  // (this part is partly splitted again)- - - - - - - - - - - - - - - - - - -
@@ -281,9 +360,9 @@ void MMCFBlock::load( const std::string & input , char frmt )
 
    if( comm == -1 )
     for( Index k = 0 ; k < NComm ; )
-     B[ k++ ][ node - 1 ] = flow;
+     B[ k++ ].mut()[ node - 1 ] = flow;
    else
-    B[ comm - 1 ][ node - 1 ] = flow;
+    B[ comm - 1 ].mut()[ node - 1 ] = flow;
    }
 
   break;
@@ -315,17 +394,17 @@ void MMCFBlock::load( const std::string & input , char frmt )
     comm--;
 
     if( origin < 0 )
-     B[ comm ][ dest - 1 ] = -flow;
+     B[ comm ].mut()[ dest - 1 ] = -flow;
     else
-     B[ comm ][ origin - 1 ] = flow;
+     B[ comm ].mut()[ origin - 1 ] = flow;
     }
    else
     if( origin < 0 )
      for( Index i = NumProd ; i-- ; )
-      B[ i ][ dest - 1 ] = -flow;
+      B[ i ].mut()[ dest - 1 ] = -flow;
     else
      for( Index i = NumProd ; i-- ; )
-      B[ i ][ origin - 1 ] = flow;
+      B[ i ].mut()[ origin - 1 ] = flow;
 
    }  // end( for( ! eof() ) )
 
@@ -361,9 +440,9 @@ void MMCFBlock::load( const std::string & input , char frmt )
      }
 
     if( dest == -1 )  // it is an origin
-     B[ i ][ origin - 1 ] = flow;
+     B[ i ].mut()[ origin - 1 ] = flow;
     else
-     B[ i ][ dest - 1 ] = - flow;
+     B[ i ].mut()[ dest - 1 ] = - flow;
     }
    else {  // comm == -1
     // origin or destination node for all the commodities ( k , origin )
@@ -382,9 +461,9 @@ void MMCFBlock::load( const std::string & input , char frmt )
       }
 
      if( dest == -1 )  // it is an origin
-      B[ i ][ origin - 1 ] = flow;
+      B[ i ].mut()[ origin - 1 ] = flow;
      else
-      B[ i ][ dest - 1 ] = - flow;
+      B[ i ].mut()[ dest - 1 ] = - flow;
 
      }  // end for( k )
     }  // end else( comm == -1 )
@@ -416,16 +495,18 @@ void MMCFBlock::load( const std::string & input , char frmt )
     Origins[ TempIdx[ comm ] ] = origin;
     Destins[ TempIdx[ comm ] ] = dest;
 
-    B[ TempIdx[ comm ] ][ dest - 1 ] = -flow;
-    B[ TempIdx[ comm ]++ ][ origin - 1 ] = flow;
+    // note: -= and += so that a commodity whose origin and destination
+    // coincide correctly gets an all-zero deficit vector
+    B[ TempIdx[ comm ] ].mut()[ dest - 1 ] -= flow;
+    B[ TempIdx[ comm ]++ ].mut()[ origin - 1 ] += flow;
     }
    else
     for( Index i = NumProd ; i-- ; ) {
      Origins[ TempIdx[ i ] ] = origin;
      Destins[ TempIdx[ i ] ] = dest;
 
-     B[ TempIdx[ i ] ][ dest - 1 ] = -flow;
-     B[ TempIdx[ i ]++ ][ origin - 1 ] = flow;
+     B[ TempIdx[ i ] ].mut()[ dest - 1 ] -= flow;
+     B[ TempIdx[ i ]++ ].mut()[ origin - 1 ] += flow;
      }
     }  // end while( ! eof() )
    }   // end default()- - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -434,7 +515,7 @@ void MMCFBlock::load( const std::string & input , char frmt )
 
  inputS.close();
 
- UTot.assign( NArcs , Inf< FNumber >() );
+ UTot.mut().assign( NArcs , Inf< FNumber >() );
 
  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
  // now the though part: reading arc info - - - - - - - - - - - - - - - - - -
@@ -484,17 +565,17 @@ void MMCFBlock::load( const std::string & input , char frmt )
    if( ptr )
     TempIdx[ ptr - 1 ] = who;
 
-   Startn[ who ] = from;
-   Endn[ who ] = to;
+   Startn.mut()[ who ] = from;
+   Endn.mut()[ who ] = to;
 
    if( comm == -1 )
     for( Index k = 0 ; k < NComm ; ) {
-     C[ k ][ who ] = cost;
-     U[ k++ ][ who ] = cap;
+     C[ k ].mut()[ who ] = cost;
+     U[ k++ ].mut()[ who ] = cap;
      }
    else {
-    C[ --comm ][ who ] = cost;
-    U[ comm ][ who ] = cap;
+    C[ --comm ].mut()[ who ] = cost;
+    U[ comm ].mut()[ who ] = cap;
     }
    }   // end while()
   }    // end if( mnetgen )
@@ -651,8 +732,8 @@ void MMCFBlock::load( const std::string & input , char frmt )
     if( ptr ) {      // if ptr != 0 it's easy
      who = ptr - 1;  // ( ptr - 1 ) is already the correct name
 
-     Startn[ who ] = from;
-     Endn[ who ] = to;
+     Startn.mut()[ who ] = from;
+     Endn.mut()[ who ] = to;
      }
     else {           // otherwise find the "name" of arc (from, to)
      Index k = 0;    // and put it into who
@@ -675,13 +756,13 @@ void MMCFBlock::load( const std::string & input , char frmt )
 
      if( k == unbndld ) {  // if no such arc exists ...
       unbndld++;           // ... a new one is created
-      Startn[ who ] = from;
-      Endn[ who ] = to;
+      Startn.mut()[ who ] = from;
+      Endn.mut()[ who ] = to;
       }
      }  // end else( ! ptr )
 
-    C[ comm ][ who ] = cost;
-    U[ comm ][ who ] = ( cap >= 0 ? cap : Inf< FNumber >() );
+    C[ comm ].mut()[ who ] = cost;
+    U[ comm ].mut()[ who ] = ( cap >= 0 ? cap : Inf< FNumber >() );
 
     } // end for( all comm. )
    }  // end while( ! eof() )
@@ -714,7 +795,7 @@ void MMCFBlock::load( const std::string & input , char frmt )
   else
    j = i++;
 
-  UTot[ j ] = ( f >= 0 ? f : Inf< FNumber >() );
+  UTot.mut()[ j ] = ( f >= 0 ? f : Inf< FNumber >() );
   }
 
  // common initializations- - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -776,42 +857,42 @@ void MMCFBlock::load( std::istream & input , char frmt )
  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
  C.resize( NComm );  // allocate costs
- F.resize( NArcs );  // allocate fixed costs
+ F.mut().resize( NArcs );  // allocate fixed costs
 
  if( frmt == 'c' )
   for( Index i = 0 ; i < NComm ; i++ )
-   C[ i ].resize( NArcs );
+   C[ i ].mut().resize( NArcs );
  else
   for( Index i = 0 ; i < NComm ; i++ )
-   C[ i ].resize( NArcs , Inf< CNumber >() );  // arcs are un-existent
+   C[ i ].mut().resize( NArcs , Inf< CNumber >() );  // arcs are un-existent
                                                // unless otherwise stated
 
  U.resize( NComm );  // allocate capacities - - - - - - - - - - - - -
 
  if( frmt == 'c' )
   for( Index i = 0 ; i < NComm ; i++ )
-   U[ i ].resize( NArcs );
+   U[ i ].mut().resize( NArcs );
  else
   for( Index i = 0 ; i < NComm ; i++ )
-   U[ i ].resize( NArcs , 0 );  // arcs are un-existent
+   U[ i ].mut().resize( NArcs , 0 );  // arcs are un-existent
                                 // unless otherwise stated
 
  B.resize( NComm );  // allocate deficits
 
  if( frmt == 'c' )
   for( Index i = 0 ; i < NComm ; i++ )
-   B[ i ].resize( NNodes );
+   B[ i ].mut().resize( NNodes );
  else
   for( Index i = 0 ; i < NComm ; i++ )
-   B[ i ].resize( NNodes , 0 );  // nodes all have 0 deficit
+   B[ i ].mut().resize( NNodes , 0 );  // nodes all have 0 deficit
                                  // unless otherwise stated
 
  // allocate start/end nodes and mutual capacities- - - - - - - - - - - - - -
 
- Startn.resize( NArcs );
- Endn.resize( NArcs );
+ Startn.mut().resize( NArcs );
+ Endn.mut().resize( NArcs );
 
- UTot.resize( NArcs );
+ UTot.mut().resize( NArcs );
 
  c_Index NumProd = NComm;
  
@@ -824,23 +905,23 @@ void MMCFBlock::load( std::istream & input , char frmt )
 
   // allocate the data structures for "extra" things- - - - - - - - - - - - -
 
-  F.resize( NArcs );
+  F.mut().resize( NArcs );
 
   for( Index i = 0 ; i < NArcs ; i++ ) {  // read arc-related info- - - - - -
-   input >> Endn[ i ];
+   input >> Endn.mut()[ i ];
    GOODN( Endn[ i ] );
 
-   input >> Startn[ i ];
+   input >> Startn.mut()[ i ];
    GOODN( Startn[ i ] );
    if( Startn[ i ] == Endn[ i ] )
     throw( std::invalid_argument( "self-loop" ) );
 
-   input >> F[ i ];
+   input >> F.mut()[ i ];
    
    FNumber f;
    input >> f;
 
-   UTot[ i ] = ( f >= 0 ? f : Inf< FNumber >() );
+   UTot.mut()[ i ] = ( f >= 0 ? f : Inf< FNumber >() );
 
    Index h;
    input >> h;
@@ -850,10 +931,10 @@ void MMCFBlock::load( std::istream & input , char frmt )
     input >> k;
     GOODP( k );
 
-    input >> C[ --k ][ i ];
+    input >> C[ --k ].mut()[ i ];
     input >> f;
 
-    U[ k ][ i ] = ( f >= 0 ? f : Inf< FNumber >() );
+    U[ k ].mut()[ i ] = ( f >= 0 ? f : Inf< FNumber >() );
 
     }  // end for( h )
    }  // end for( i )
@@ -867,7 +948,7 @@ void MMCFBlock::load( std::istream & input , char frmt )
 
    FNumber f;
    input >> f;
-   B[ --k ][ --i ] = -f;
+   B[ --k ].mut()[ --i ] = -f;
    }
 
   break;
@@ -880,33 +961,33 @@ void MMCFBlock::load( std::istream & input , char frmt )
 
   for( Index k = 0 ; k < NComm ; k++ )  // read all costs
    for( Index i = 0 ; i < NArcs ; )
-    input >> C[ k ][ i++ ];
+    input >> C[ k ].mut()[ i++ ];
 
   for( Index k = 0 ; k < NComm ; k++ )  // read all capacities
    for( Index i = 0 ; i < NArcs ; ) {
     FNumber f;
     input >> f;
-    U[ k ][ i++ ] = ( f >= 0 ? f : Inf< FNumber >() );
+    U[ k ].mut()[ i++ ] = ( f >= 0 ? f : Inf< FNumber >() );
     }
 
   for( Index k = 0 ; k < NComm ; k++ )  // read all supplies
    for( Index i = 0 ; i < NNodes ; ) {
     FNumber f;
     input >> f;
-    B[ k ][ i++ ] = -f;
+    B[ k ].mut()[ i++ ] = -f;
     }
 
   for( Index i = 0 ; i < NArcs ; ) {      // read all total capacities
    FNumber f;
    input >> f;
-   UTot[ i++ ] = ( f >= 0 ? f : Inf< FNumber >() );
+   UTot.mut()[ i++ ] = ( f >= 0 ? f : Inf< FNumber >() );
    }
 
   for( Index i = 0 ; i < NArcs ; i++ ) {  // read graph topology
-   input >> Startn[ i ];
+   input >> Startn.mut()[ i ];
    GOODN( Startn[ i ] );
 
-   input >> Endn[ i ];
+   input >> Endn.mut()[ i ];
    GOODN( Endn[ i ] );
 
    if( Startn[ i ] == Endn[ i ] )
@@ -919,12 +1000,12 @@ void MMCFBlock::load( std::istream & input , char frmt )
 
    // TODO: properly implement this, B[] is NComm long and this code is
    //       no longer working
-   B[ NComm ].resize( NXtrC );
-   B[ NComm + 1 ].resize( NXtrC );
+   B[ NComm ].mut().resize( NXtrC );
+   B[ NComm + 1 ].mut().resize( NXtrC );
 
    for( Index i = 0 ; i < NXtrC ; ) {  // read "extra" Uppr./Lwr. bounds
-    input >> B[ NComm ][ i ];
-    input >> B[ NComm + 1 ][ i++ ];
+    input >> B[ NComm ].mut()[ i ];
+    input >> B[ NComm + 1 ].mut()[ i++ ];
     }
 
    Index currc = 0;
@@ -968,192 +1049,616 @@ void MMCFBlock::load( std::istream & input , char frmt )
 
 /*--------------------------------------------------------------------------*/
 
-void MMCFBlock::generate_abstract_variables( Configuration * stvv )
+void MMCFBlock::load( Index nn , Index na , Index nc , Subset && sn ,
+		      Subset && en , CMultiVector && c , FMultiVector && u ,
+		      FMultiVector && b , Vec_FNumber && utot ,
+		      Vec_CNumber && f )
 {
- if( AR & HasVar ) {
-  // TODO: check if stvv agrees with the formulation we currently have
-  //       and throw exception otherwise
-  return;
-  }
+ // check the data before touching anything- - - - - - - - - - - - - - - - -
 
- // TODO: check stvv and construct other formulations accordingly
- unsigned char fr = 0;
- auto c = dynamic_cast< SimpleConfiguration< int > * >( stvv );
- if( ( ! c ) && f_BlockConfig &&
-     f_BlockConfig->f_static_variables_Configuration )
-  c = dynamic_cast< SimpleConfiguration< int > * >(
-                        f_BlockConfig->f_static_variables_Configuration );
- if( c )
-  fr = c->value();
- 
- AR = ( AR & ( ~4 ) ) | ( 4 * fr );
-  
- // initialize the children - - - - - - - - - - - - - - - - - - - - - - - - -
+ if( nn <= 1 )
+  throw( std::invalid_argument( "wrong node number" ) );
+ if( na <= 0 )
+  throw( std::invalid_argument( "wrong arc number" ) );
+ if( nc <= 0 )
+  throw( std::invalid_argument( "wrong commodity number" ) );
 
- if( ! ( AR & KnapsackRelaxation ) ) {
-  v_Block.resize( NComm );
- 
+ if( ( sn.size() != na ) || ( en.size() != na ) || ( utot.size() != na ) ||
+     ( ( ! f.empty() ) && ( f.size() != na ) ) )
+  throw( std::invalid_argument( "MMCFBlock::load: wrong arc data size" ) );
+
+ for( Index i = 0 ; i < na ; ++i )
+  if( ( sn[ i ] < 1 ) || ( sn[ i ] > nn ) || ( en[ i ] < 1 ) ||
+      ( en[ i ] > nn ) )
+   throw( std::invalid_argument( "Invalid actual node name" ) );
+
+ if( ( c.size() != nc ) || ( u.size() != nc ) ||
+     ( ( ! b.empty() ) && ( b.size() != nc ) ) )
+  throw( std::invalid_argument(
+			"MMCFBlock::load: wrong commodity data size" ) );
+
+ for( Index k = 0 ; k < nc ; ++k )
+  if( ( c[ k ].size() != na ) || ( u[ k ].size() != na ) ||
+      ( ( ! b.empty() ) && ( b[ k ].size() != nn ) ) )
+   throw( std::invalid_argument(
+			"MMCFBlock::load: wrong commodity data size" ) );
+
+ // ensure starting from clean slate
+ guts_of_destructor();
+
+ // move the data in- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+ NNodes = nn;
+ NArcs = na;
+ NComm = nc;
+ NCnst = NArcs;
+
+ Startn = std::move( sn );
+ Endn = std::move( en );
+ to_shared( C , std::move( c ) );
+ to_shared( U , std::move( u ) );
+ UTot = std::move( utot );
+
+ if( b.empty() )
+  b.assign( NComm , Vec_FNumber( NNodes , 0 ) );
+ to_shared( B , std::move( b ) );
+
+ if( f.empty() )
+  F.mut().assign( NArcs , 0 );
+ else
+  F = std::move( f );
+
+ // common initializations- - - - - - - - - - - - - - - - - - - - - - - - - -
+ CmnIntlz();
+
+ // issue Modification- - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ // note: this is a NBModification, the "nuclear option"
+
+ if( anyone_there() )
+  add_Modification( std::make_shared< NBModification >( this ) );
+
+ }  // end( MMCFBlock::load( in-memory ) )
+
+/*--------------------------------------------------------------------------*/
+
+MMCFBlock * MMCFBlock::clone( Block * father ) const
+{
+ auto blk = new MMCFBlock( father );
+
+ // the instance data: the SharedVector are shared, not copied- - - - - - - -
+
+ blk->NNodes = NNodes;
+ blk->NArcs = NArcs;
+ blk->NComm = NComm;
+ blk->NCnst = NCnst;
+
+ blk->C = C;
+ blk->U = U;
+ blk->B = B;
+ // in out-of-core mode the rows must not refer to the file of this
+ // MMCFBlock, which is rewritten (or truncated) under them: the clone
+ // keeps its data in memory
+ if( OOCMap )
   for( Index k = 0 ; k < NComm ; ++k ) {
-   //!! TODO: if( PT[ k ] == kSPT ) do something more clever
-   auto MCFb = new MCFBlock( this );
-   MCFb->load( NNodes , NArcs , Startn , Endn , U[ k ] , C[ k ] , B[ k ] );
-   v_Block[ k ] = MCFb;
+   blk->C[ k ].unmap();
+   blk->U[ k ].unmap();
+   if( k < blk->B.size() )
+    blk->B[ k ].unmap();
+   }
+ blk->I = I;
+ blk->UTot = UTot;
+ blk->F = F;
+ blk->Startn = Startn;
+ blk->Endn = Endn;
+ blk->Active = Active;
+ blk->ActiveK = ActiveK;
+
+ blk->NXtrV = NXtrV;
+ blk->NXtrC = NXtrC;
+ blk->IdxBeg = IdxBeg;
+ blk->CoefIdx = CoefIdx;
+ blk->CoefVal = CoefVal;
+
+ // the data derived from it- - - - - - - - - - - - - - - - - - - - - - - - -
+
+ blk->FSBeg = FSBeg;
+ blk->FSArc = FSArc;
+ blk->StrtNme = StrtNme;
+ blk->NamesK = NamesK;
+ blk->DrctdPrb = DrctdPrb;
+ blk->PT = PT;
+ blk->RmvdK = RmvdK;
+ blk->CIsCpy = CIsCpy;
+ blk->UIsCpy = UIsCpy;
+ blk->BIsCpy = BIsCpy;
+ blk->f_sense = f_sense;
+
+ // the state of PreProcess() - - - - - - - - - - - - - - - - - - - - - - - -
+
+ blk->PPDone = PPDone;
+ blk->PPIncUk = PPIncUk;
+ blk->PPDecUk = PPDecUk;
+ blk->PPIncUjk = PPIncUjk;
+ blk->PPDecUjk = PPDecUjk;
+ blk->PPChgDfct = PPChgDfct;
+ blk->PPDecCsts = PPDecCsts;
+ blk->MaxFlwK = MaxFlwK;
+ blk->MaxFlw = MaxFlw;
+ blk->UTotOrg = UTotOrg;
+ blk->USqzd = USqzd;
+ blk->FirstK = FirstK;
+ blk->NCommGlb = NCommGlb;
+ blk->SubNode = SubNode;
+ blk->SubArc = SubArc;
+ blk->SubComm = SubComm;
+ blk->CrsNode = CrsNode;
+ blk->CrsArc = CrsArc;
+ blk->CrsComm = CrsComm;
+ blk->CrsArcW = CrsArcW;
+ blk->CrsCommW = CrsCommW;
+
+ // the abstract representation is constructed if and when required: since
+ // AR == 0 in blk, the set of formulated commodities can be recomputed
+ blk->find_trivial_commodities();
+
+ return( blk );
+
+ }  // end( MMCFBlock::clone )
+
+/*--------------------------------------------------------------------------*/
+
+MMCFBlock * MMCFBlock::extract( c_Subset & comms , c_Subset & arcs ,
+				Block * father ) const
+{
+ // the sets of commodities and arcs, ordered- - - - - - - - - - - - - - - -
+
+ Subset ks( comms.begin() , comms.end() );
+ std::sort( ks.begin() , ks.end() );
+ ks.erase( std::unique( ks.begin() , ks.end() ) , ks.end() );
+ if( ( ! ks.empty() ) && ( ks.back() >= NComm ) )
+  throw( std::invalid_argument( "MMCFBlock::extract: wrong commodity" ) );
+ if( ks.size() == NComm )
+  ks.clear();
+
+ Subset as( arcs.begin() , arcs.end() );
+ std::sort( as.begin() , as.end() );
+ as.erase( std::unique( as.begin() , as.end() ) , as.end() );
+ if( ( ! as.empty() ) && ( as.back() >= NArcs ) )
+  throw( std::invalid_argument( "MMCFBlock::extract: wrong arc" ) );
+ if( as.size() == NArcs )
+  as.clear();
+
+ // the nodes are the endpoints of the arcs - - - - - - - - - - - - - - - - -
+
+ Subset ns;
+ if( ! as.empty() ) {
+  for( auto i : as ) {
+   ns.push_back( Startn[ i ] - StrtNme );
+   ns.push_back( Endn[ i ] - StrtNme );
    }
+  std::sort( ns.begin() , ns.end() );
+  ns.erase( std::unique( ns.begin() , ns.end() ) , ns.end() );
+  if( ns.size() == NNodes )
+   ns.clear();
+  }
+
+ // construct the sub-instance- - - - - - - - - - - - - - - - - - - - - - - -
+ // all the data that is not restricted is shared with this MMCFBlock (as in
+ // clone()), the rest is copied; the data is the original one, i.e., the
+ // capacities squeezed by PreProcess() (if any) are restored
+
+ auto blk = new MMCFBlock( father );
+
+ blk->NNodes = ns.empty() ? NNodes : ns.size();
+ blk->NArcs = as.empty() ? NArcs : as.size();
+ blk->NComm = ks.empty() ? NComm : ks.size();
+ blk->NCnst = blk->NArcs;
+
+ if( ns.empty() ) {
+  blk->Startn = gather( Startn , as );
+  blk->Endn = gather( Endn , as );
   }
  else {
-  //construct vectors for the flow relaxation
-  int items;
-  std::vector< double > bound;
-  std::vector< bool > Integrality;
-  FMultiVector weights;
-  FMultiVector costs;
-  double Cmax = 0;
-  double Umax = 0;
-  double sumF = 0;
-  int sumQ = 0;
-
-   int i = 0;
-   
-   for( int j = 0 ; j < NNodes ; j++ )
-    for( int k = 0 ; k < NComm ; k++ ) {
-     if( B[ k ][ j ] > 0 )
-      sumQ += B[ k ][ j ];
-    }  
-   
-   for( int j = 0 ; j < NArcs ; j++ ){
-    for( int k = 0 ; k < NComm ; k++ ) {
-     if( C[ k ][ j ] < Inf< double >() ) 
-      Cmax += C[ k ][ j ];
-     if( U[ k ][ j ] > 0 ) 
-      Umax += U[ k ][ j ]; 
-     sumF += F[ j ]; 
-    }
+  blk->Startn.mut().resize( blk->NArcs );
+  blk->Endn.mut().resize( blk->NArcs );
+  for( Index h = 0 ; h < blk->NArcs ; ++h ) {
+   const Index i = as[ h ];
+   blk->Startn.mut()[ h ] = sub_index( ns , Startn[ i ] - StrtNme ) + 1;
+   blk->Endn.mut()[ h ] = sub_index( ns , Endn[ i ] - StrtNme ) + 1;
    }
+  }
 
-   Umax = 10 * Umax * NNodes * sumQ;
-   Cmax = 10 * Cmax * NNodes * sumQ * Umax;
-   
-  if( ( NCnst != NArcs ) && Active.size() ) {
-   weights.resize( NArcs );  // allocate weights for the knapsack sub-problem
-   costs.resize( NArcs );  // allocate costs for the knapsack sub-problem
-   bound.resize( NArcs );
+ if( PPDone )
+  blk->UTot = gather( SharedVector< FNumber >( UTotOrg ) , as );
+ else
+  blk->UTot = gather( UTot , as );
+ if( F.size() == NArcs )
+  blk->F = gather( F , as );
+
+ blk->C.resize( blk->NComm );
+ blk->U.resize( blk->NComm );
+ blk->B.resize( blk->NComm );
+ for( Index h = 0 ; h < blk->NComm ; ++h ) {
+  const Index k = ks.empty() ? h : ks[ h ];
+  blk->C[ h ] = gather( C[ k ] , as );
+  blk->B[ h ] = gather( B[ k ] , ns );
+  if( ( k < USqzd.size() ) && ( ! USqzd[ k ].empty() ) ) {
+   Vec_FNumber uk( U[ k ].begin() , U[ k ].end() );
+   for( auto & sq : USqzd[ k ] )
+    uk[ sq.first ] = sq.second;
+   blk->U[ h ] = gather( SharedVector< FNumber >( std::move( uk ) ) , as );
+   }
+  else
+   blk->U[ h ] = gather( U[ k ] , as );
 
+  if( OOCMap ) {  // as in clone(), the rows must not refer to the file
+   blk->C[ h ].unmap();
+   blk->U[ h ].unmap();
+   blk->B[ h ].unmap();
+   }
+  }
 
-   for( Index j = 0 ; j < NArcs ; j++ ) {
-    if( F.size() == NArcs && sumF>0 ) {
-     weights[ j ].resize( NComm + 1 );
-     costs[ j ].resize( NComm + 1 );
-     }
-    else {
-     weights[ j ].resize( NComm );
-     costs[ j ].resize( NComm );
-     }
+ blk->f_sense = f_sense;
+ blk->SubNode = std::move( ns );
+ blk->SubArc = std::move( as );
+ blk->SubComm = std::move( ks );
 
-    for( Index k = 0 ; k < NComm ; k++ ) {
-     weights[ j ][ k ] = U[ k ][ j ];
-     costs[ j ][ k ] =  C[ k ][ j ] * U[ k ][ j ];
-     if( C[ k ][ j ] >= Inf< double >() )
-      costs[ j ][ k ] = Cmax; 
-     }
+ blk->CmnIntlz();
 
-    if( F.size() == NArcs && sumF>0) {
-     costs[ j ][ NComm ] =  F[ j ];
-     weights[ j ][ NComm ] = - UTot[ j ];
-     }
+ return( blk );
 
-    items = NComm;
-    if( F.size() == NArcs && sumF>0) {
-     items++;
-     Integrality.resize( NComm + 1 );
-     for( Index k = 0 ; k < NComm ; ++k )
-      Integrality[ k ] = false; 
-     Integrality[ NComm ] = true; 
-     for( Index j = 0 ; j < NArcs ; ++j )
-      bound[ j ] = 0;
-     }
-    else {
-     Integrality.resize(NComm);
-     for( Index k = 0 ; k < NComm ; ++k )
-      Integrality[ k ] = false;
-     for( Index j = 0 ; j < NArcs ; ++j )
-      bound[ j ] = UTot[ j ];
-     }
-    }
+ }  // end( MMCFBlock::extract )
+
+/*--------------------------------------------------------------------------*/
+
+MMCFBlock * MMCFBlock::coarsen( c_Subset & clst , Block * father ) const
+{
+ if( clst.size() != NNodes )
+  throw( std::invalid_argument( "MMCFBlock::coarsen: wrong clusters" ) );
+
+ const Index nc = NNodes ? *std::max_element( clst.begin() , clst.end() ) + 1
+                         : 0;
+
+ // the coarse arcs, one for each pair of distinct clusters- - - - - - - - -
 
-   v_Block.resize( NArcs );
+ Subset CArc( NArcs , Inf< Index >() );
+ Subset sn;
+ Subset en;
+ {
+  std::map< std::pair< Index , Index > , Index > byend;
+  for( Index i = 0 ; i < NArcs ; ++i ) {
+   const Index cu = clst[ Startn[ i ] - StrtNme ];
+   const Index cv = clst[ Endn[ i ] - StrtNme ];
+   if( cu == cv )  // inside a cluster
+    continue;
 
-   for( Index j = 0 ; j < NArcs ; j++ ) {
-    auto BKb = new BinaryKnapsackBlock( this );
-    BKb->load( items , bound[ j ] , weights[ j ] , costs[ j ] ,
-	       Integrality ); 
-    BKb->set_objective_sense( false );
-    v_Block[ j ] = BKb;
+   auto ins = byend.insert( std::make_pair( std::make_pair( cu , cv ) ,
+					    Index( sn.size() ) ) );
+   if( ins.second ) {
+    sn.push_back( cu + 1 );
+    en.push_back( cv + 1 );
     }
+   CArc[ i ] = ins.first->second;
+   }
+  }
+ const Index na = sn.size();
+
+ // the coarse mutual capacities and fixed costs, and the arc shares- - - -
+ // the data is the original one, as in extract()
+
+ const Vec_FNumber utf = PPDone ? UTotOrg
+                                : Vec_FNumber( UTot.begin() , UTot.end() );
+ const bool hasF = ( F.size() == NArcs );
+
+ Vec_FNumber ut( na , 0 );
+ Vec_CNumber f;
+ if( hasF )
+  f.assign( na , Inf< CNumber >() );
+ Subset cnt( na , 0 );   // # of fine arcs
+ Subset ninf( na , 0 );  // # of fine arcs with no mutual capacity
+ for( Index i = 0 ; i < NArcs ; ++i ) {
+  const Index a = CArc[ i ];
+  if( a == Inf< Index >() )
+   continue;
+  ut[ a ] += utf[ i ];
+  ++cnt[ a ];
+  if( utf[ i ] == Inf< FNumber >() )
+   ++ninf[ a ];
+  if( hasF )
+   f[ a ] = std::min( f[ a ] , F[ i ] );
+  }
+
+ Vec_FNumber aw( NArcs , 0 );
+ for( Index i = 0 ; i < NArcs ; ++i ) {
+  const Index a = CArc[ i ];
+  if( a == Inf< Index >() )
+   continue;
+  if( ninf[ a ] )
+   aw[ i ] = utf[ i ] == Inf< FNumber >() ? FNumber( 1 ) / ninf[ a ] : 0;
+  else
+   aw[ i ] = ut[ a ] > 0 ? utf[ i ] / ut[ a ] : FNumber( 1 ) / cnt[ a ];
+  }
+
+ // the coarse commodities - - - - - - - - - - - - - - - - - - - - - - - - -
+ // same coarse costs, origins and destinations: the rest is summed up
+
+ CMultiVector cc;
+ FMultiVector cu;
+ FMultiVector cb;
+ Subset CComm( NComm , Inf< Index >() );
+ Vec_FNumber sup( NComm , 0 );  // supply of each fine commodity
+ Vec_FNumber csup;              // supply of each coarse commodity
+ std::map< std::pair< Subset , Subset > , Subset > byod;
+
+ Vec_CNumber c( na );
+ Vec_FNumber u( na );
+ Vec_FNumber b( nc );
+ for( Index k = 0 ; k < NComm ; ++k ) {
+  b.assign( nc , 0 );
+  for( Index v = 0 ; v < NNodes ; ++v )
+   b[ clst[ v ] ] += B[ k ][ v ];
+
+  Subset org;
+  Subset dst;
+  for( Index w = 0 ; w < nc ; ++w )
+   if( b[ w ] < 0 )
+    org.push_back( w );
+   else
+    if( b[ w ] > 0 )
+     dst.push_back( w );
+  if( org.empty() && dst.empty() )  // all inside a cluster
+   continue;
+
+  Vec_FNumber uk( U[ k ].begin() , U[ k ].end() );
+  if( k < USqzd.size() )
+   for( auto & sq : USqzd[ k ] )
+    uk[ sq.first ] = sq.second;
+
+  c.assign( na , Inf< CNumber >() );
+  u.assign( na , 0 );
+  for( Index i = 0 ; i < NArcs ; ++i ) {
+   const Index a = CArc[ i ];
+   if( ( a == Inf< Index >() ) || ( C[ k ][ i ] == Inf< CNumber >() ) )
+    continue;
+   c[ a ] = std::min( c[ a ] , C[ k ][ i ] );
+   u[ a ] += uk[ i ];
+   }
+
+  for( auto bw : b )
+   sup[ k ] += std::abs( bw );
+
+  auto & qs = byod[ std::make_pair( std::move( org ) , std::move( dst ) ) ];
+  auto q = qs.begin();
+  for( ; q != qs.end() ; ++q )
+   if( cc[ *q ] == c )
+    break;
+
+  if( q != qs.end() ) {
+   for( Index a = 0 ; a < na ; ++a )
+    cu[ *q ][ a ] += u[ a ];
+   for( Index w = 0 ; w < nc ; ++w )
+    cb[ *q ][ w ] += b[ w ];
+   CComm[ k ] = *q;
    }
   else {
-   weights.resize( NArcs  );  // allocate weights for the knapsack sub-problem
-   costs.resize( NArcs  );  // allocate costs for the knapsack sub-problem
- 
-   for( Index j = 0 ; j < NArcs ; j++ ) {
-    if( F.size() == NArcs  && sumF>0) {
-     weights[ j ].resize( NComm + 1 );
-     costs[ j ].resize( NComm + 1 );
-     }
-    else {
-     weights[ j ].resize( NComm );
-     costs[ j ].resize( NComm );
-     }
+   CComm[ k ] = cc.size();
+   qs.push_back( cc.size() );
+   cc.push_back( c );
+   cu.push_back( u );
+   cb.push_back( b );
+   csup.push_back( 0 );
+   }
+  csup[ CComm[ k ] ] += sup[ k ];
+  }
 
-    for( Index k = 0 ;k < NComm ; k++ )
-     Cmax += NNodes * C[ k ][ j ];
+ Vec_FNumber kw( NComm , 0 );
+ for( Index k = 0 ; k < NComm ; ++k )
+  if( ( CComm[ k ] < Inf< Index >() ) && ( csup[ CComm[ k ] ] > 0 ) )
+   kw[ k ] = sup[ k ] / csup[ CComm[ k ] ];
 
-    for( Index k = 0 ; k < NComm ; k++ ) {
-     weights[ j ][ k ] = U[ k ][ j ];
-     costs[ j ][ k ] =  C[ k ][ j ] * U[ k ][ j ];
-     if( C[ k ][ j ] >= Inf< double >() ) {
-      costs[ j ][ k ] = Cmax * U[ k ][ j ];
-      weights[ j ][ k ] = Umax;
-      }
-     }
+ // construct the coarse instance - - - - - - - - - - - - - - - - - - - - -
 
-    if( F.size() == NArcs && sumF>0 ) {
-     costs[ j ][ NComm ] = F[ j ];
-     weights[ j ][ NComm ] = - UTot[ j ];
-     }
-    }
+ const Index nq = cc.size();
+ std::unique_ptr< MMCFBlock > blk( new MMCFBlock( father ) );
+ blk->load( nc , na , nq , std::move( sn ) , std::move( en ) ,
+	    std::move( cc ) , std::move( cu ) , std::move( cb ) ,
+	    std::move( ut ) , std::move( f ) );
 
-   bound.resize( NArcs );
-   items = NComm;
-   if( F.size() == NArcs && sumF>0 ) {
-    items++;
-    Integrality.resize( NComm + 1 );
-    for( Index j = 0 ; j < NComm ; ++j )
-     Integrality[ j ] = false;
-    Integrality[ NComm ] = true; 
-    for( Index j = 0 ; j < NArcs ; ++j )
-     bound[ j ] = 0;
-    }
-   else {
-    Integrality.resize( NComm );
-    for( Index j = 0 ; j < NComm ; ++j )
-     Integrality[ j ] = false;
-    for( Index j = 0 ; j < NArcs ; ++j )
-     bound[ j ] = UTot[ j ];
+ blk->f_sense = f_sense;
+ blk->CrsNode.assign( clst.begin() , clst.end() );
+ blk->CrsArc = std::move( CArc );
+ blk->CrsComm = std::move( CComm );
+ blk->CrsArcW = std::move( aw );
+ blk->CrsCommW = std::move( kw );
+
+ return( blk.release() );
+
+ }  // end( MMCFBlock::coarsen )
+
+/*--------------------------------------------------------------------------*/
+
+Block::Subset MMCFBlock::cluster_nodes( Index nn ) const
+{
+ Subset clst( NNodes );
+ std::iota( clst.begin() , clst.end() , Index( 0 ) );
+ Index ncl = NNodes;
+
+ // the arcs by nonincreasing mutual capacity
+ Subset ord( NArcs );
+ std::iota( ord.begin() , ord.end() , Index( 0 ) );
+ std::stable_sort( ord.begin() , ord.end() ,
+		   [ this ]( Index a , Index b ) {
+		    return( UTot[ a ] > UTot[ b ] ); } );
+
+ while( ncl > nn ) {
+  // one matching pass: to[ c ] is the new cluster of the old cluster c
+  Subset to( ncl , Inf< Index >() );
+  Index nnew = 0;
+  Index cur = ncl;
+  for( auto i : ord ) {
+   if( cur <= nn )
+    break;
+   const Index cu = clst[ Startn[ i ] - StrtNme ];
+   const Index cv = clst[ Endn[ i ] - StrtNme ];
+   if( ( cu == cv ) || ( to[ cu ] < Inf< Index >() ) ||
+       ( to[ cv ] < Inf< Index >() ) )
+    continue;
+   to[ cu ] = to[ cv ] = nnew++;
+   --cur;
+   }
+
+  if( cur == ncl )  // nothing merged
+   break;
+
+  for( auto & t : to )  // the clusters not merged are kept
+   if( t == Inf< Index >() )
+    t = nnew++;
+  for( auto & cl : clst )
+   cl = to[ cl ];
+  ncl = nnew;
+  }
+
+ return( clst );
+
+ }  // end( MMCFBlock::cluster_nodes )
+
+/*--------------------------------------------------------------------------*/
+
+void MMCFBlock::set_out_of_core( const std::string & fname , Index maxres )
+{
+ if( ! maxres )
+  throw( std::invalid_argument(
+		     "MMCFBlock::set_out_of_core: maxres must be positive" ) );
+
+ // read back all the data, if any, and forget about the current file
+ for( Index k = 0 ; k < C.size() ; ++k ) {
+  C[ k ].unmap();
+  U[ k ].unmap();
+  B[ k ].unmap();
+  }
+
+ OOCLRU.clear();
+ OOCPos.clear();
+ OOCMap.reset();
+ OOCRows = 0;
+
+ OOCFile = fname;
+ OOCMaxRes = maxres;
+
+ // if there is an instance, immediately move it to the file, keeping in
+ // memory only the last maxres commodities
+ if( ( ! OOCFile.empty() ) && ( ! C.empty() ) )
+  ooc_open();
+
+ }  // end( MMCFBlock::set_out_of_core )
+
+/*--------------------------------------------------------------------------*/
+
+void MMCFBlock::generate_abstract_variables( Configuration * stvv )
+{
+ if( AR & HasVar ) {
+  // TODO: check if stvv agrees with the formulation we currently have
+  //       and throw exception otherwise
+  return;
+  }
+
+ // read the formulation, and possibly the arcs of the hybrid one, out of
+ // either stvv or the BlockConfig
+ unsigned char fr = 0;
+ Subset hyb;
+ bool hybgvn = false;
+ auto read_cfg = [ & ]( Configuration * cfg ) {
+  if( auto c = dynamic_cast< SimpleConfiguration< int > * >( cfg ) ) {
+   fr = c->value();
+   return( true );
+   }
+  if( auto c = dynamic_cast< SimpleConfiguration< std::vector< int > > * >(
+								     cfg ) ) {
+   const auto & v = c->value();
+   if( v.empty() )
+    return( false );
+   fr = v.front();
+   hyb.reserve( v.size() - 1 );
+   for( auto it = std::next( v.begin() ) ; it != v.end() ; ++it ) {
+    if( ( *it < 0 ) || ( Index( *it ) >= NArcs ) )
+     throw( std::invalid_argument( "MMCFBlock: invalid hybrid arc " +
+				   std::to_string( *it ) ) );
+    hyb.push_back( *it );
     }
+   hybgvn = true;
+   return( true );
+   }
+  return( false );
+  };
+
+ if( ( ! read_cfg( stvv ) ) && f_BlockConfig )
+  read_cfg( f_BlockConfig->f_static_variables_Configuration );
+
+ AR &= ~( KnapsackRelaxation | PathFormulation | HybridFormulation |
+	  LazySubBlocks );
+ if( fr & 4 ) {  // the MCFBlock are constructed lazily
+  AR |= LazySubBlocks;
+  fr &= ~4;
+  }
+ switch( fr ) {
+  case( 0 ): break;
+  case( 1 ): AR |= KnapsackRelaxation; break;
+  case( 2 ): AR |= PathFormulation; break;
+  case( 3 ): AR |= HybridFormulation; break;
+  default:
+   throw( std::invalid_argument( "MMCFBlock: unknown formulation " +
+				 std::to_string( int( fr ) ) ) );
+  }
+
+ if( AR & PathFormulation ) {  // the arc-path formulation- - - - - - - - - -
+  generate_path_variables();   // has no sub-Block, it is all done here
+  AR |= HasVar;
+  return;
+  }
+
+ // initialize the children - - - - - - - - - - - - - - - - - - - - - - - - -
+
+ // note: only the non-trivial commodities are formulated, the position of
+ // commodity k in the formulation being k2p( k )
+ const Index NF = get_NFrmlK();
 
-   v_Block.resize( NArcs );
-   for( Index j = 0 ; j < NArcs; j++ ) {
-    auto BKb = new BinaryKnapsackBlock( this );
-    BKb->load( items , bound[ j ] , weights[ j ] , costs[ j ] ,
-	       Integrality ); 
-    BKb->set_objective_sense( false );
-    v_Block[ j ] = BKb;
+ if( ! ( AR & KnapsackRelaxation ) ) {
+  v_Block.assign( NF , nullptr );
+  if( ! ( AR & LazySubBlocks ) )  // else, they are constructed when needed
+   for( Index h = 0 ; h < NF ; ++h )
+    v_Block[ h ] = new_mcf_block( p2k( h ) );
+
+  if( AR & HybridFormulation ) {
+   // by default, the arcs handled by a knapsack are these with an active
+   // mutual capacity constraint
+   if( ! hybgvn ) {
+    if( ( NCnst != NArcs ) && Active.size() )
+     hyb.assign( Active.begin() , Active.begin() + NCnst );
+    else
+     for( Index j = 0 ; j < NArcs ; ++j )
+      if( UTot[ j ] < Inf< FNumber >() )
+       hyb.push_back( j );
     }
+
+   std::sort( hyb.begin() , hyb.end() );
+   hyb.erase( std::unique( hyb.begin() , hyb.end() ) , hyb.end() );
+   generate_hybrid_knapsacks( std::move( hyb ) );
    }
   }
+ else {
+  AR &= ~LazySubBlocks;  // the knapsacks are always there
+  generate_knapsacks();
+  }
 
- // call the base class method to have it done in the sub-Block, if any
- Block::generate_abstract_variables();
+ // call the base class method to have it done in the sub-Block, if any,
+ // skipping these not constructed yet
+ if( AR & LazySubBlocks ) {
+  for( auto bk : v_Block )
+   if( bk )
+    bk->generate_abstract_variables();
+  }
+ else
+  Block::generate_abstract_variables();
 
  AR |= HasVar;
  }
@@ -1178,148 +1683,2874 @@ void MMCFBlock::generate_abstract_constraints( Configuration * stcc )
 
  AR = ( AR & ( ~slc ) ) | ( slc * sl );
 
+ // the linking constraints need all the MCFBlock, construct the missing
+ // ones, if any (this generates their variables only, since HasMutual is
+ // not there yet)
+ if( AR & LazySubBlocks )
+  for( Index h = 0 ; h < get_NFrmlK() ; ++h )
+   mcf_block( h );
+
  // do it in the MCF/BKB respectively
  for( auto blck : v_Block )
   blck->generate_abstract_constraints();
 
+ if( AR & PathFormulation )
+  generate_path_constraints();
+ else
  if( ! ( AR & KnapsackRelaxation ) ) {
-  // count number of nonzeroes in each constraint, i.e., #FS( i ) + #BS( i )
-  Subset count( get_NArcs() );
-  
-  // initialize the vectors of coefficients, and reset count[]
-  std::vector< LinearFunction::v_coeff_pair > coeffs( get_NArcs() );
-
-  for( Index j = 0 ; j < get_NArcs() ; ++j ) {
-   coeffs[ j ].resize( NComm );
-   count[ j ] = 0;
+  // the arcs having a row in MCs: all the active ones (all if PreProcess()
+  // has not been called), save these handled by a knapsack in the hybrid
+  // formulation
+  const bool allA = ( NCnst == NArcs ) || Active.empty();
+  const Index nr = allA ? NArcs : NCnst;
+  MCArc.clear();
+  MCArc.reserve( nr );
+  for( Index j = 0 ; j < nr ; ++j ) {
+   const Index i = allA ? j : Active[ j ];
+   if( ! in_hybrid( i ) )
+    MCArc.push_back( i );
    }
 
-  for( Index k = 0 ; k < get_NComm() ; ++k )
-   for( Index j = 0 ; j < get_NArcs() ; ++j )
-    coeffs[ j ][ k ] = std::make_pair(
-      static_cast< MCFBlock * >( v_Block[ k ] )->i2p_x( j ) , double( 1 ) );
-
   // generate the mutual capacity constraints  - - - - - - - - - - - - - - -
   // each constraint is an inequality, i.e., RHS = UTot[ j ]
-  if( ( NCnst != NArcs ) && Active.size() ) {
-   MCs.resize( NCnst );
-   for( Index j = 0 ; j < NCnst ; ++j ) {
-    if( UTot[ Active[ j ] ] >= Inf< double >() )
-     throw( std::logic_error( "Constraint required to have a finite rhs" ) );
-
-    MCs[ j ].set_function( new LinearFunction(
-				  std::move( coeffs[ Active[ j ] ] ) , 0 ) );
-    MCs[ j ].set_rhs( UTot[ Active[ j ] ] );
-    MCs[ j ].set_lhs( -Inf< double >() );
-    }
-   }
-  else{
-   MCs.resize( get_NArcs() );
-   for( Index j = 0 ; j < get_NArcs() ; ++j ) {
-    if( UTot[ j ] >= Inf< double >() )
-     throw( std::logic_error( "Constraint required to have a finite rhs" ) );
-    MCs[ j ].set_rhs( UTot[ j ] );
-    MCs[ j ].set_lhs( -Inf< double >() );
-    MCs[ j ].set_function( new LinearFunction( std::move( coeffs[ j ] ) , 0 ) );
-    }
+  // note: trivial commodities have no variables, hence they do not appear
+  MCs.resize( MCArc.size() );
+  for( Index r = 0 ; r < MCs.size() ; ++r ) {
+   const Index i = MCArc[ r ];
+   if( UTot[ i ] >= Inf< double >() )
+    throw( std::logic_error( "Constraint required to have a finite rhs" ) );
+
+   LinearFunction::v_coeff_pair coeffs( get_NFrmlK() );
+   for( Index h = 0 ; h < get_NFrmlK() ; ++h )
+    coeffs[ h ] = std::make_pair(
+      mcf_block( h )->i2p_x( i ) , double( 1 ) );
+
+   MCs[ r ].set_rhs( UTot[ i ] );
+   MCs[ r ].set_lhs( -Inf< double >() );
+   MCs[ r ].set_function( new LinearFunction( std::move( coeffs ) , 0 ) );
    }
 
   add_static_constraint( MCs , "Mut" );
+
+  if( ! HybArcs.empty() )
+   generate_hybrid_constraints();
   }
- else { 
-  // count number of nonzeroes in each constraint, i.e., #FS( i ) + #BS( i )
-  std::vector< Subset > count( get_NComm() );
- 
-  // initialize the vectors of coefficients, and reset count[]
-  boost::multi_array< LinearFunction::v_coeff_pair , 2 > coeffs(
-			    boost::extents[ get_NComm()] [ get_NNodes() ] );
+ else
+  generate_knapsack_constraints();
 
-  for( Index k = 0 ; k < get_NComm() ; ++k ) {
-   count[ k ].resize( get_NNodes() );
-   if( NCnst != NArcs && Active.size() ) {
-    for( Index i = 0 ; i < NArcs ; ++i ) {
-     count[ k ][ Startn[ i ] - 1 ]++;
-     count[ k ][ Endn[ i ] - 1 ]++;
-     }
-    }
-   else {
-    for( Index i = 0 ; i < get_NArcs() ; ++i ) {
-     count[ k ][ Startn[ i ] - 1 ]++;
-     count[ k ][ Endn[ i ] - 1 ]++;
-     }
-    } 
-   }
-  
-  for( Index k = 0 ; k < get_NComm() ; ++k )
-   for( Index i = 0 ; i < get_NNodes() ; ++i ) {
-    coeffs[ k ][ i ].resize( count[ k ][ i ] );
-    count[ k ][ i ] = 0;
-    }
+ AR |= HasMutual;
 
-  // construct the vector of coefficients, static phase
-  for( Index k = 0 ; k < get_NComm() ; ++k ) {
-   for( Index i = 0; i < get_NArcs() ; ++i ) {
-    if( Startn[ i ] == Endn[ i ])
-     continue;
-    coeffs[ k ][ Startn[ i ] - 1 ][ count[ k ][ Startn[ i ] - 1 ]++ ] =
-     std::make_pair( ( static_cast< BinaryKnapsackBlock * >( v_Block[ i ] )->get_Var( k )) , double( U[ k ][ i ] ) );
-    coeffs[ k ][ Endn[ i ] - 1 ][ count[ k ][ Endn[ i ] - 1 ]++ ] =
-     std::make_pair( ( static_cast< BinaryKnapsackBlock * >( v_Block[ i ] )->get_Var( k )) , double( - U[ k ][ i ]  )  ) ;
-    }
+ }  // end( MMCFBlock::generate_abstract_constraints() )
+/*--------------------------------------------------------------------------*/
+
+void MMCFBlock::generate_knapsacks( void )
+{
+ const Index NF = get_NFrmlK();
+ const bool dsgn = has_design();
+
+ // a bound on the flow of each commodity: the one computed by PreProcess(),
+ // if any, otherwise the total supply plus the capacity of the arcs with
+ // negative cost (which may be used by cycles)
+ auto & mfk = KnpMxF;
+ mfk.resize( NF );
+ for( Index h = 0 ; h < NF ; ++h ) {
+  const Index k = p2k( h );
+  mfk[ h ] = PPDone ? MaxFlwK[ k ]
+                    : knp_max_flow( C[ k ] , U[ k ] ,
+				    B.empty() ? Vec_FNumber() : B[ k ].get() );
+  }
+
+ // the items of the knapsack of arc j are the commodities that can use it,
+ // i.e., with finite cost and nonzero scale s^k_j = min( U , UTot , mfk );
+ // the design item, if any, comes last
+ KnpItm.resize( NArcs );
+ KnpScl.resize( NArcs );
+ v_Block.resize( NArcs );
+
+ std::vector< double > weights;
+ std::vector< double > costs;
+ std::vector< bool > Integrality;
+
+ for( Index j = 0 ; j < NArcs ; ++j ) {
+  auto & itm = KnpItm[ j ];
+  auto & scl = KnpScl[ j ];
+  itm.clear();
+  scl.clear();
+  weights.clear();
+  costs.clear();
+
+  for( Index h = 0 ; h < NF ; ++h ) {
+   const Index k = p2k( h );
+   if( C[ k ][ j ] >= Inf< CNumber >() )
+    continue;
+   const FNumber sk = knp_scale( h , j );
+   if( sk <= 0 )
+    continue;
+   if( sk >= Inf< FNumber >() )
+    throw( std::logic_error( "MMCFBlock: unbounded flow of commodity " +
+			     std::to_string( k ) + " on arc " +
+			     std::to_string( j ) ) );
+   itm.push_back( h );
+   scl.push_back( sk );
+   weights.push_back( sk );
+   costs.push_back( C[ k ][ j ] * sk );
    }
 
-  FCs.resize( boost::extents[ get_NComm() ][ get_NNodes() ] );
-  for( Index i = 0; i < get_NNodes() ; ++i ) {
-   for( Index k = 0 ; k < get_NComm() ; ++k ) {  
-    (FCs)[ k ][ i ].set_both( B.empty() ? 0 : B[ k ][ i ] );
-    (FCs)[ k ][ i ].set_function(
-		  new LinearFunction( std::move( coeffs[ k ][ i ] ) , 0 ) );
-    }
+  Integrality.assign( itm.size() , false );
+  if( dsgn ) {
+   weights.push_back( - UTot[ j ] );
+   costs.push_back( F[ j ] );
+   Integrality.push_back( true );
    }
 
-  add_static_constraint( FCs , "Flow" );
+  auto BKb = new BinaryKnapsackBlock( this );
+  BKb->load( weights.size() , dsgn ? 0 : UTot[ j ] , weights , costs ,
+	     Integrality );
+  BKb->set_objective_sense( false );
+  v_Block[ j ] = BKb;
+  }
+ }  // end( MMCFBlock::generate_knapsacks )
 
-  if( AR & slc ) {
-   boost::multi_array< LinearFunction::v_coeff_pair , 2 > coeffsSLC(
-			     boost::extents[ get_NComm() ][ get_NArcs() ] );
+/*--------------------------------------------------------------------------*/
 
-   for( Index k = 0 ; k < get_NComm() ; ++k )
-    for( Index i = 0 ; i < get_NArcs() ; ++i )
-     coeffsSLC[ k ][ i ].resize( 2 );
+FNumber MMCFBlock::knp_max_flow( const Vec_CNumber & c , const Vec_FNumber & u ,
+				 const Vec_FNumber & b ) const
+{
+ FNumber mf = 0;
+ for( auto bi : b )  // |b| counts both supply and demand, hence / 2
+  mf += std::abs( bi );
+ mf /= 2;
 
-   // construct the vector of coefficients, static phase
-   for( Index k = 0 ; k < get_NComm() ; ++k ) {
-    for(  Index i = 0; i < get_NArcs() ; ++i ) {
-     coeffsSLC[ k ][ i ][ 0 ] =
-      std::make_pair( ( static_cast< BinaryKnapsackBlock * >( v_Block[ i ] )->get_Var( k )) , double( 1 ) );
-     coeffsSLC[ k ][ i ][ 1 ] =
-      std::make_pair( ( static_cast< BinaryKnapsackBlock * >( v_Block[ i ] )->get_Var( get_NComm() )) , double( -1 )  );
-     }
-    }
+ for( Index j = 0 ; j < NArcs ; ++j )
+  if( c[ j ] < 0 )
+   mf += std::min( u[ j ] , UTot[ j ] );
 
-   SLCs.resize( boost::extents[ get_NComm() ][ get_NArcs() ] );
- 
-   for( Index i = 0; i < get_NArcs() ; ++i ) {
-    for( Index k = 0 ; k < get_NComm() ; ++k ) {   
-     (SLCs)[ k ][ i ].set_lhs( -Inf< double >() );
-     (SLCs)[ k ][ i ].set_rhs( 0 );
-     (SLCs)[ k ][ i ].set_function(
-	      new LinearFunction( std::move( coeffsSLC[ k ][ i ] ) , 0 ) );
-     }
-    }
+ return( mf );
+ }
+
+/*--------------------------------------------------------------------------*/
+
+void MMCFBlock::generate_knapsack_constraints( void )
+{
+ // note: only the non-trivial commodities have flow constraints, those of
+ // commodity k being the row k2p( k ) of FCs
+ const Index NF = get_NFrmlK();
+
+ boost::multi_array< LinearFunction::v_coeff_pair , 2 > coeffs(
+			    boost::extents[ NF ][ get_NNodes() ] );
 
-   add_static_constraint( SLCs , "StrongForcCons" );
+ // construct the vector of coefficients: the items of commodity h on arc
+ // j, scaled by s^k_j; self-loops do not appear in the flow constraints
+ for( Index j = 0 ; j < get_NArcs() ; ++j ) {
+  if( Startn[ j ] == Endn[ j ] )
+   continue;
+  auto BKb = static_cast< BinaryKnapsackBlock * >( v_Block[ j ] );
+  for( Index t = 0 ; t < KnpItm[ j ].size() ; ++t ) {
+   const Index h = KnpItm[ j ][ t ];
+   const double s = KnpScl[ j ][ t ];
+   coeffs[ h ][ Startn[ j ] - StrtNme ].push_back(
+				  std::make_pair( BKb->get_Var( t ) , s ) );
+   coeffs[ h ][ Endn[ j ] - StrtNme ].push_back(
+				  std::make_pair( BKb->get_Var( t ) , -s ) );
    }
   }
 
- AR |= HasMutual;
+ FCs.resize( boost::extents[ NF ][ get_NNodes() ] );
+ for( Index i = 0; i < get_NNodes() ; ++i ) {
+  for( Index k = 0 ; k < NF ; ++k ) {  
+   (FCs)[ k ][ i ].set_both( B.empty() ? 0 : B[ p2k( k ) ][ i ] );
+   (FCs)[ k ][ i ].set_function(
+		  new LinearFunction( std::move( coeffs[ k ][ i ] ) , 0 ) );
+   }
+  }
 
- }  // end( MMCFBlock::generate_abstract_constraints() )
+ add_static_constraint( FCs , "Flow" );
 
-/*--------------------------------------------------------------------------*/
-/*-------------------------- PROTECTED METHODS -----------------------------*/
-/*--------------------------------------------------------------------------*/
- 
+ if( ! ( ( AR & slc ) && has_design() ) )
+  return;
+
+ // the strong linking constraints z^k_j - y_j <= 0; these of the items
+ // that do not exist are left empty (i.e., 0 <= 0)
+ SLCs.resize( boost::extents[ NF ][ get_NArcs() ] );
+ for( Index j = 0 ; j < get_NArcs() ; ++j ) {
+  auto BKb = static_cast< BinaryKnapsackBlock * >( v_Block[ j ] );
+  const Index dt = KnpItm[ j ].size();
+  Index t = 0;
+  for( Index h = 0 ; h < NF ; ++h ) {
+   LinearFunction::v_coeff_pair coeffsSLC;
+   if( ( t < dt ) && ( KnpItm[ j ][ t ] == h ) ) {
+    coeffsSLC.resize( 2 );
+    coeffsSLC[ 0 ] = std::make_pair( BKb->get_Var( t++ ) , double( 1 ) );
+    coeffsSLC[ 1 ] = std::make_pair( BKb->get_Var( dt ) , double( -1 ) );
+    }
+   (SLCs)[ h ][ j ].set_lhs( -Inf< double >() );
+   (SLCs)[ h ][ j ].set_rhs( 0 );
+   (SLCs)[ h ][ j ].set_function(
+		    new LinearFunction( std::move( coeffsSLC ) , 0 ) );
+   }
+  }
+
+ add_static_constraint( SLCs , "StrongForcCons" );
+
+ }  // end( MMCFBlock::generate_knapsack_constraints )
+
+/*--------------------------------------------------------------------------*/
+
+void MMCFBlock::generate_hybrid_knapsacks( Subset && hyb )
+{
+ const Index NF = get_NFrmlK();
+ const bool dsgn = has_design();
+ const Index items = dsgn ? NF + 1 : NF;
+
+ HybArcs = std::move( hyb );
+ HybPos.assign( NArcs , Inf< Index >() );
+
+ // the flow items are continuous, the design one (if any) is integer
+ std::vector< bool > Integrality( items , false );
+ if( dsgn )
+  Integrality[ NF ] = true;
+
+ // the costs C stay in the MCFBlock, hence only the design item has one
+ std::vector< double > weights( items );
+ std::vector< double > costs( items , 0 );
+
+ v_Block.reserve( NF + HybArcs.size() );
+ for( Index r = 0 ; r < HybArcs.size() ; ++r ) {
+  const Index i = HybArcs[ r ];
+  if( UTot[ i ] >= Inf< FNumber >() )
+   throw( std::logic_error( "MMCFBlock: hybrid arc " + std::to_string( i ) +
+			    " has no finite mutual capacity" ) );
+  HybPos[ i ] = r;
+
+  for( Index h = 0 ; h < NF ; ++h )
+   weights[ h ] = hyb_scale( p2k( h ) , i );
+
+  if( dsgn ) {
+   costs[ NF ] = F[ i ];
+   weights[ NF ] = - UTot[ i ];
+   }
+
+  auto BKb = new BinaryKnapsackBlock( this );
+  BKb->load( items , dsgn ? 0 : UTot[ i ] , weights , costs , Integrality );
+  BKb->set_objective_sense( false );
+  v_Block.push_back( BKb );
+  }
+ }  // end( MMCFBlock::generate_hybrid_knapsacks )
+
+/*--------------------------------------------------------------------------*/
+
+void MMCFBlock::generate_hybrid_constraints( void )
+{
+ const Index NF = get_NFrmlK();
+ const Index NH = HybArcs.size();
+
+ // the copy constraints x^k_i - s^k_i z^k_i = 0 - - - - - - - - - - - - - -
+
+ HCs.resize( boost::extents[ NF ][ NH ] );
+ for( Index h = 0 ; h < NF ; ++h ) {
+  const Index k = p2k( h );
+  auto MCFb = mcf_block( h );
+  for( Index r = 0 ; r < NH ; ++r ) {
+   const Index i = HybArcs[ r ];
+   LinearFunction::v_coeff_pair coeffs( 2 );
+   coeffs[ 0 ] = std::make_pair( MCFb->i2p_x( i ) , double( 1 ) );
+   coeffs[ 1 ] = std::make_pair( hyb_block( i )->get_Var( h ) ,
+				 - double( hyb_scale( k , i ) ) );
+   HCs[ h ][ r ].set_both( 0 );
+   HCs[ h ][ r ].set_function(
+			  new LinearFunction( std::move( coeffs ) , 0 ) );
+   }
+  }
+
+ add_static_constraint( HCs , "Copy" );
+
+ // the strong linking constraints z^k_i - y_i <= 0, if required - - - - - -
+
+ if( ! ( ( AR & slc ) && has_design() ) )
+  return;
+
+ SLCs.resize( boost::extents[ NF ][ NH ] );
+ for( Index r = 0 ; r < NH ; ++r ) {
+  auto BKb = hyb_block( HybArcs[ r ] );
+  for( Index h = 0 ; h < NF ; ++h ) {
+   LinearFunction::v_coeff_pair coeffs( 2 );
+   coeffs[ 0 ] = std::make_pair( BKb->get_Var( h ) , double( 1 ) );
+   coeffs[ 1 ] = std::make_pair( BKb->get_Var( NF ) , double( -1 ) );
+   SLCs[ h ][ r ].set_lhs( -Inf< double >() );
+   SLCs[ h ][ r ].set_rhs( 0 );
+   SLCs[ h ][ r ].set_function(
+			   new LinearFunction( std::move( coeffs ) , 0 ) );
+   }
+  }
+
+ add_static_constraint( SLCs , "StrongForcCons" );
+
+ }  // end( MMCFBlock::generate_hybrid_constraints )
+
+/*--------------------------------------------------------------------------*/
+
+void MMCFBlock::generate_objective( Configuration * objc )
+{
+ if( ! ( AR & PathFormulation ) ) {  // the Objective is that of the
+  if( AR & LazySubBlocks ) {          // sub-Block, skipping these not
+   for( auto bk : v_Block )           // constructed yet
+    if( bk )
+     bk->generate_objective();
+   }
+  else
+   Block::generate_objective( objc );
+  AR |= HasObjective;
+  return;
+  }
+
+ if( PathObj.get_function() )  // the Objective is already there
+  return;
+
+ LinearFunction::v_coeff_pair coeffs;
+ for( Index h = 0 ; h < get_NFrmlK() ; ++h ) {
+  const auto & Ck = C[ p2k( h ) ];
+  auto pit = PathArcs[ h ].begin();
+  for( auto & var : PathVars[ h ] ) {
+   CNumber cost = 0;
+   for( auto i : *(pit++) )
+    cost += Ck[ i ];
+   coeffs.push_back( std::make_pair( & var , cost ) );
+   }
+
+  coeffs.push_back( std::make_pair( & PathSlk[ h ] , PathBigM[ h ] ) );
+  }
+
+ PathObj.set_function( new LinearFunction( std::move( coeffs ) , 0 ) );
+ PathObj.set_sense( Objective::eMin , eNoMod );
+ set_objective( & PathObj , eNoMod );
+
+ }  // end( MMCFBlock::generate_objective )
+
+/*--------------------------------------------------------------------------*/
+
+Block * MMCFBlock::generate_sub_Block( Index h )
+{
+ if( h >= v_Block.size() )
+  throw( std::invalid_argument( "MMCFBlock::generate_sub_Block: invalid "
+				"position " + std::to_string( h ) ) );
+
+ if( ! v_Block[ h ] )  // only the MCFBlock can be missing
+  v_Block[ h ] = new_mcf_block( p2k( h ) );
+
+ return( v_Block[ h ] );
+ }
+
+/*--------------------------------------------------------------------------*/
+
+MCFBlock * MMCFBlock::new_mcf_block( Index k )
+{
+ //!! TODO: if( PT[ k ] == kSPT ) do something more clever
+ ooc_touch( k );
+ auto MCFb = new MCFBlock( this );
+ if( LgrLmb.empty() )
+  MCFb->load( NNodes , NArcs , Startn , Endn , U[ k ] , C[ k ] , B[ k ] );
+ else  // the MCFBlock has the Lagrangian costs
+  MCFb->load( NNodes , NArcs , Startn , Endn , U[ k ] , mcf_costs( k ) ,
+	      B[ k ] );
+
+ // if the abstract representation is already (being) constructed, the new
+ // MCFBlock must have the same
+ if( AR & HasVar )
+  MCFb->generate_abstract_variables();
+ if( AR & HasMutual )
+  MCFb->generate_abstract_constraints();
+ if( AR & HasObjective )
+  MCFb->generate_objective();
+
+ return( MCFb );
+ }
+
+/*--------------------------------------------------------------------------*/
+
+Block::Index MMCFBlock::price_paths( double eps , ModParam issueMod )
+{
+ if( ! ( ( AR & PathFormulation ) && ( AR & HasMutual ) ) )
+  throw( std::logic_error(
+		       "MMCFBlock::price_paths: no arc-path formulation" ) );
+
+ // the dual values of the mutual capacity constraints, arc-wise- - - - - - -
+
+ Vec_CNumber lambda( NArcs , 0 );
+ for( Index r = 0 ; r < MCs.size() ; ++r )
+  lambda[ MCArc[ r ] ] = MCs[ r ].get_dual();
+
+ const Index NF = get_NFrmlK();
+ if( PathPi.size() != NF )
+  PathPi.assign( NF , Vec_CNumber( NNodes , 0 ) );
+
+ Vec_CNumber len( NArcs );
+ Vec_CNumber dist;
+ Subset pred;
+ Index added = 0;
+
+ for( auto & grp : PathGrps ) {
+  // all the commodities in grp share the origin and the reduced costs- - -
+  const Index h0 = grp.front();
+  const auto & Ck = C[ p2k( h0 ) ];
+  for( Index i = 0 ; i < NArcs ; ++i )
+   len[ i ] = ( Ck[ i ] < Inf< CNumber >() ) ? Ck[ i ] - lambda[ i ]
+                                            : Inf< CNumber >();
+
+  // only singleton groups can have individual capacity constraints
+  for( Index r = PathICBeg[ h0 ] ; r < PathICBeg[ h0 + 1 ] ; ++r )
+   len[ PathICArc[ r ] ] -= PathICs[ r ].get_dual();
+
+  if( ! sp_tree( PathOrg[ h0 ] , len , dist , pred ) )
+   throw( std::logic_error(
+		  "MMCFBlock::price_paths: negative reduced cost cycle" ) );
+
+  for( auto h : grp ) {
+   // the potentials, with the convention that C - pi_i + pi_j >= 0- - - -
+   auto & pi = PathPi[ h ];
+   for( Index v = 0 ; v < NNodes ; ++v )
+    pi[ v ] = dist[ v ] < Inf< CNumber >() ? - dist[ v ] : 0;
+
+   const Index d = PathDst[ h ];
+   if( ( dist[ d ] == Inf< CNumber >() ) ||
+       ( dist[ d ] - PathDCs[ h ].get_dual() >= - eps ) )
+    continue;
+
+   // reconstruct the path, backwards- - - - - - - - - - - - - - - - - - -
+   Subset P;
+   for( Index v = d ; v != PathOrg[ h ] ; v = Startn[ P.back() ] - StrtNme )
+    P.push_back( pred[ v ] );
+   std::reverse( P.begin() , P.end() );
+
+   // with degenerate dual values a path already there may be found
+   if( std::find( PathArcs[ h ].begin() , PathArcs[ h ].end() , P ) !=
+       PathArcs[ h ].end() )
+    continue;
+
+   add_path( h , std::move( P ) , issueMod );
+   ++added;
+   }
+  }
+
+ return( added );
+
+ }  // end( MMCFBlock::price_paths )
+
+/*--------------------------------------------------------------------------*/
+
+void MMCFBlock::generate_path_variables( void )
+{
+ const Index NF = get_NFrmlK();
+
+ // find origin, destination and demand of each commodity - - - - - - - - -
+
+ PathOrg.resize( NF );
+ PathDst.resize( NF );
+ PathDmd.resize( NF );
+ for( Index h = 0 ; h < NF ; ++h ) {
+  const auto & Bk = B[ p2k( h ) ];
+  Index no = 0;
+  Index nd = 0;
+  for( Index v = 0 ; v < NNodes ; ++v )
+   if( Bk[ v ] < 0 ) {
+    PathOrg[ h ] = v;
+    ++no;
+    }
+   else
+    if( Bk[ v ] > 0 ) {
+     PathDst[ h ] = v;
+     PathDmd[ h ] = Bk[ v ];
+     ++nd;
+     }
+
+  if( ( no != 1 ) || ( nd != 1 ) )
+   throw( std::logic_error( "MMCFBlock: arc-path formulation requires "
+			    "single origin / destination commodities" ) );
+  }
+
+ // find the individual capacities that can be binding- - - - - - - - - - -
+
+ PathICBeg.resize( NF + 1 );
+ PathICArc.clear();
+ for( Index h = 0 ; h < NF ; ++h ) {
+  PathICBeg[ h ] = PathICArc.size();
+  const Index k = p2k( h );
+  for( Index i = 0 ; i < NArcs ; ++i )
+   if( ( C[ k ][ i ] < Inf< CNumber >() ) && ( U[ k ][ i ] < PathDmd[ h ] ) )
+    PathICArc.push_back( i );
+  }
+ PathICBeg[ NF ] = PathICArc.size();
+
+ // group the commodities that can share the same shortest path tree: - - -
+ // same origin, same costs and no individual capacity constraints - - - - -
+
+ PathGrps.clear();
+ {
+  Subset byorg( NNodes , Inf< Index >() );  // last group with that origin
+  Subset prvgrp;                            // previous group, same origin
+  for( Index h = 0 ; h < NF ; ++h ) {
+   if( PathICBeg[ h + 1 ] == PathICBeg[ h ] ) {
+    Index g = byorg[ PathOrg[ h ] ];
+    for( ; g != Inf< Index >() ; g = prvgrp[ g ] ) {
+     const Index h0 = PathGrps[ g ].front();
+     if( ( PathICBeg[ h0 + 1 ] == PathICBeg[ h0 ] ) &&
+	 ( C[ p2k( h0 ) ] == C[ p2k( h ) ] ) )
+      break;
+     }
+
+    if( g != Inf< Index >() ) {
+     PathGrps[ g ].push_back( h );
+     continue;
+     }
+    }
+
+   prvgrp.push_back( byorg[ PathOrg[ h ] ] );
+   byorg[ PathOrg[ h ] ] = PathGrps.size();
+   PathGrps.push_back( Subset( 1 , h ) );
+   }
+  }
+
+ // the artificial variables, with cost larger than that of any path - - - -
+
+ PathSlk.resize( NF );
+ PathBigM.resize( NF );
+ for( Index h = 0 ; h < NF ; ++h ) {
+  PathSlk[ h ].set_Block( this );
+  PathSlk[ h ].set_type( ColVariable::kNonNegative , eNoMod );
+
+  CNumber M = 1;
+  for( auto c : C[ p2k( h ) ] )
+   if( c < Inf< CNumber >() )
+    M += std::abs( c );
+  PathBigM[ h ] = M;
+  }
+
+ add_static_variable( PathSlk , "PathSlk" );
+
+ // the path variables, initially only the shortest path w.r.t. costs- - - -
+
+ PathVars.clear();
+ PathVars.resize( NF );
+ PathArcs.clear();
+ PathArcs.resize( NF );
+
+ for( Index h = 0 ; h < NF ; ++h )
+  add_dynamic_variable( PathVars[ h ] , "Path" );
+
+ Vec_CNumber dist;
+ Subset pred;
+ for( auto & grp : PathGrps ) {
+  if( ! sp_tree( PathOrg[ grp.front() ] , C[ p2k( grp.front() ) ] ,
+		 dist , pred ) )
+   throw( std::logic_error( "MMCFBlock: negative cost cycle" ) );
+
+  for( auto h : grp ) {
+   if( dist[ PathDst[ h ] ] == Inf< CNumber >() )
+    continue;  // only the artificial variable, the problem is infeasible
+
+   Subset P;
+   for( Index v = PathDst[ h ] ; v != PathOrg[ h ] ;
+	v = Startn[ P.back() ] - StrtNme )
+    P.push_back( pred[ v ] );
+   std::reverse( P.begin() , P.end() );
+
+   add_path( h , std::move( P ) , eNoMod );
+   }
+  }
+ }  // end( MMCFBlock::generate_path_variables )
+
+/*--------------------------------------------------------------------------*/
+
+void MMCFBlock::generate_path_constraints( void )
+{
+ const Index NF = get_NFrmlK();
+
+ // mutual capacity constraints - - - - - - - - - - - - - - - - - - - - - - -
+
+ const bool allA = ( NCnst == NArcs ) || Active.empty();
+ MCArc.resize( allA ? NArcs : NCnst );
+ for( Index r = 0 ; r < MCArc.size() ; ++r )
+  MCArc[ r ] = allA ? r : Active[ r ];
+
+ MCs.resize( MCArc.size() );
+ std::vector< LinearFunction::v_coeff_pair > coeffs( MCs.size() );
+
+ for( Index h = 0 ; h < NF ; ++h ) {
+  auto pit = PathArcs[ h ].begin();
+  for( auto & var : PathVars[ h ] ) {
+   for( auto i : *(pit++) ) {
+    const auto r = mc_row( i );
+    if( r < MCs.size() )
+     coeffs[ r ].push_back( std::make_pair( & var , double( 1 ) ) );
+    }
+   }
+  }
+
+ for( Index r = 0 ; r < MCs.size() ; ++r ) {
+  const Index i = MCArc[ r ];
+  if( UTot[ i ] >= Inf< double >() )
+   throw( std::logic_error( "Constraint required to have a finite rhs" ) );
+
+  MCs[ r ].set_function( new LinearFunction( std::move( coeffs[ r ] ) , 0 ) );
+  MCs[ r ].set_rhs( UTot[ i ] );
+  MCs[ r ].set_lhs( -Inf< double >() );
+  }
+
+ add_static_constraint( MCs , "Mut" );
+
+ // demand constraints- - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+ PathDCs.resize( NF );
+ for( Index h = 0 ; h < NF ; ++h ) {
+  LinearFunction::v_coeff_pair dc;
+  dc.reserve( PathVars[ h ].size() + 1 );
+  for( auto & var : PathVars[ h ] )
+   dc.push_back( std::make_pair( & var , double( 1 ) ) );
+  dc.push_back( std::make_pair( & PathSlk[ h ] , double( 1 ) ) );
+
+  PathDCs[ h ].set_function( new LinearFunction( std::move( dc ) , 0 ) );
+  PathDCs[ h ].set_both( PathDmd[ h ] );
+  }
+
+ add_static_constraint( PathDCs , "Dmd" );
+
+ // individual capacity constraints - - - - - - - - - - - - - - - - - - - - -
+
+ PathICs.resize( PathICArc.size() );
+ for( Index h = 0 ; h < NF ; ++h ) {
+  const Index k = p2k( h );
+  for( Index r = PathICBeg[ h ] ; r < PathICBeg[ h + 1 ] ; ++r ) {
+   LinearFunction::v_coeff_pair ic;
+   auto pit = PathArcs[ h ].begin();
+   for( auto & var : PathVars[ h ] ) {
+    if( std::find( pit->begin() , pit->end() , PathICArc[ r ] ) !=
+	pit->end() )
+     ic.push_back( std::make_pair( & var , double( 1 ) ) );
+    ++pit;
+    }
+
+   PathICs[ r ].set_function( new LinearFunction( std::move( ic ) , 0 ) );
+   PathICs[ r ].set_rhs( U[ k ][ PathICArc[ r ] ] );
+   PathICs[ r ].set_lhs( -Inf< double >() );
+   }
+  }
+
+ add_static_constraint( PathICs , "Ind" );
+
+ }  // end( MMCFBlock::generate_path_constraints )
+
+/*--------------------------------------------------------------------------*/
+
+void MMCFBlock::add_path( Index h , Subset && P , ModParam issueMod )
+{
+ std::list< ColVariable > nv( 1 );
+ nv.front().set_Block( this );
+ nv.front().set_type( ColVariable::kNonNegative , eNoMod );
+
+ if( ! ( AR & HasVar ) )  // the formulation is being constructed
+  PathVars[ h ].splice( PathVars[ h ].end() , nv );
+ else
+  add_dynamic_variables( PathVars[ h ] , nv , issueMod );
+
+ auto var = & PathVars[ h ].back();
+
+ if( AR & HasMutual ) {  // add the variable to the constraints- - - - - - -
+  for( auto i : P ) {
+   const auto r = mc_row( i );
+   if( r < MCs.size() )
+    static_cast< LinearFunction * >( MCs[ r ].get_function() )->add_variable(
+						       var , 1 , issueMod );
+   }
+
+  static_cast< LinearFunction * >( PathDCs[ h ].get_function()
+				   )->add_variable( var , 1 , issueMod );
+
+  for( Index r = PathICBeg[ h ] ; r < PathICBeg[ h + 1 ] ; ++r )
+   if( std::find( P.begin() , P.end() , PathICArc[ r ] ) != P.end() )
+    static_cast< LinearFunction * >( PathICs[ r ].get_function()
+				     )->add_variable( var , 1 , issueMod );
+  }
+
+ if( PathObj.get_function() ) {  // add the variable to the Objective- - - -
+  const auto & Ck = C[ p2k( h ) ];
+  CNumber cost = 0;
+  for( auto i : P )
+   cost += Ck[ i ];
+
+  static_cast< LinearFunction * >( PathObj.get_function() )->add_variable(
+						    var , cost , issueMod );
+  }
+
+ PathArcs[ h ].push_back( std::move( P ) );
+
+ }  // end( MMCFBlock::add_path )
+
+/*--------------------------------------------------------------------------*/
+
+double MMCFBlock::path_flow( Index h , Index i ) const
+{
+ double fi = 0;
+ auto pit = PathArcs[ h ].begin();
+ for( auto & var : PathVars[ h ] ) {
+  if( std::find( pit->begin() , pit->end() , i ) != pit->end() )
+   fi += var.get_value();
+  ++pit;
+  }
+
+ return( fi );
+ }
+
+/*--------------------------------------------------------------------------*/
+
+void MMCFBlock::path_flow( Index h , std::vector< double > & fk ) const
+{
+ auto pit = PathArcs[ h ].begin();
+ for( auto & var : PathVars[ h ] ) {
+  const double fp = var.get_value();
+  if( fp )
+   for( auto i : *pit )
+    fk[ i ] += fp;
+  ++pit;
+  }
+ }
+
+/*--------------------------------------------------------------------------*/
+
+void MMCFBlock::get_all_flows( double * x , bool arcmjr ) const
+{
+ std::fill( x , x + std::size_t( NComm ) * NArcs , double( 0 ) );
+ if( ! ( AR & HasVar ) )
+  return;
+
+ if( AR & KnapsackRelaxation ) {
+  // one pass over the knapsacks, each one read once: each arc only writes
+  // the flows on itself, hence the arcs can be done in parallel
+  #pragma omp parallel for schedule( dynamic , 64 )
+  for( Index i = 0 ; i < NArcs ; ++i ) {
+   auto BKb = static_cast< BinaryKnapsackBlock * >( v_Block[ i ] );
+   const auto & itm = KnpItm[ i ];
+   const auto & scl = KnpScl[ i ];
+   if( arcmjr ) {
+    double * xi = x + std::size_t( i ) * NComm;
+    for( Index t = 0 ; t < itm.size() ; ++t )
+     xi[ p2k( itm[ t ] ) ] = scl[ t ] * BKb->get_x( t );
+    }
+   else
+    for( Index t = 0 ; t < itm.size() ; ++t )
+     x[ std::size_t( p2k( itm[ t ] ) ) * NArcs + i ] =
+      scl[ t ] * BKb->get_x( t );
+   }
+
+  return;
+  }
+
+ // all the other formulations: one pass per formulated commodity, each
+ // reading the flows of its own sub-Block (or paths), in parallel
+ const Index nf = get_NFrmlK();
+ #pragma omp parallel
+ {
+  std::vector< double > fk( NArcs );
+  #pragma omp for schedule( dynamic )
+  for( Index h = 0 ; h < nf ; ++h ) {
+   const Index k = p2k( h );
+   get_local_flow( fk , k );
+   if( arcmjr )
+    for( Index i = 0 ; i < NArcs ; ++i )
+     x[ std::size_t( i ) * NComm + k ] = fk[ i ];
+   else
+    std::copy( fk.begin() , fk.end() , x + std::size_t( k ) * NArcs );
+   }
+  }
+ }  // end( MMCFBlock::get_all_flows )
+
+/*--------------------------------------------------------------------------*/
+
+void MMCFBlock::get_potentials( double * pi , Index k ) const
+{
+ if( ( ! ( AR & HasMutual ) ) || is_trivial( k ) ) {
+  std::fill( pi , pi + NNodes , double( 0 ) );
+  return;
+  }
+
+ const Index h = k2p( k );
+
+ if( AR & PathFormulation ) {
+  if( PathPi.empty() )
+   std::fill( pi , pi + NNodes , double( 0 ) );
+  else
+   std::copy( PathPi[ h ].begin() , PathPi[ h ].end() , pi );
+  }
+ else
+  if( ! ( AR & KnapsackRelaxation ) ) {
+   auto MCFb = static_cast< MCFBlock * >( v_Block[ h ] );
+   if( MCFb )
+    for( Index n = 0 ; n < NNodes ; ++n )
+     pi[ n ] = MCFb->get_pi( n );
+   else  // a MCFBlock not constructed yet
+    std::fill( pi , pi + NNodes , double( 0 ) );
+   }
+  else
+   for( Index n = 0 ; n < NNodes ; ++n )
+    pi[ n ] = FCs[ h ][ n ].get_dual();
+ }
+
+/*--------------------------------------------------------------------------*/
+
+void MMCFBlock::set_potentials( const double * pi , Index k )
+{
+ if( ( ! ( AR & HasMutual ) ) || is_trivial( k ) )
+  return;
+
+ const Index h = k2p( k );
+
+ if( AR & PathFormulation ) {
+  if( PathPi.empty() )
+   PathPi.assign( get_NFrmlK() , Vec_CNumber( NNodes , 0 ) );
+  std::copy( pi , pi + NNodes , PathPi[ h ].begin() );
+  }
+ else
+  if( ! ( AR & KnapsackRelaxation ) ) {
+   auto MCFb = mcf_block( h );
+   for( Index n = 0 ; n < NNodes ; ++n )
+    MCFb->set_pi( pi[ n ] , n );
+   }
+  else
+   for( Index n = 0 ; n < NNodes ; ++n )
+    FCs[ h ][ n ].set_dual( pi[ n ] );
+ }
+
+/*--------------------------------------------------------------------------*/
+
+void MMCFBlock::get_all_potentials( double * pi ) const
+{
+ #pragma omp parallel for schedule( dynamic )
+ for( Index k = 0 ; k < NComm ; ++k )
+  get_potentials( pi + std::size_t( k ) * NNodes , k );
+ }
+
+/*--------------------------------------------------------------------------*/
+
+void MMCFBlock::set_all_potentials( const double * pi )
+{
+ if( ! ( AR & HasMutual ) )
+  return;
+
+ // what set_potentials() may construct is constructed here, sequentially
+ if( AR & PathFormulation ) {
+  if( PathPi.empty() )
+   PathPi.assign( get_NFrmlK() , Vec_CNumber( NNodes , 0 ) );
+  }
+ else
+  if( ! ( AR & KnapsackRelaxation ) )
+   for( Index h = 0 ; h < get_NFrmlK() ; ++h )
+    mcf_block( h );
+
+ #pragma omp parallel for schedule( dynamic )
+ for( Index k = 0 ; k < NComm ; ++k )
+  set_potentials( pi + std::size_t( k ) * NNodes , k );
+ }
+
+/*--------------------------------------------------------------------------*/
+
+void MMCFBlock::get_duals( double * d ) const
+{
+ std::fill( d , d + NArcs , double( 0 ) );
+ if( ! ( AR & HasMutual ) )
+  return;
+
+ if( AR & KnapsackRelaxation ) {
+  #pragma omp parallel for schedule( static )
+  for( Index i = 0 ; i < NArcs ; ++i )
+   d[ i ] = static_cast< BinaryKnapsackBlock * >( v_Block[ i ] )->get_dual();
+  return;
+  }
+
+ #pragma omp parallel for schedule( static )
+ for( Index r = 0 ; r < MCs.size() ; ++r )
+  d[ MCArc[ r ] ] = MCs[ r ].get_dual();
+
+ for( auto i : HybArcs )
+  d[ i ] = hyb_block( i )->get_dual();
+ }
+
+/*--------------------------------------------------------------------------*/
+
+void MMCFBlock::set_duals( const double * d )
+{
+ if( ! ( AR & HasMutual ) )
+  return;
+
+ if( AR & KnapsackRelaxation ) {
+  #pragma omp parallel for schedule( static )
+  for( Index i = 0 ; i < NArcs ; ++i )
+   static_cast< BinaryKnapsackBlock * >( v_Block[ i ] )->set_dual( d[ i ] );
+  return;
+  }
+
+ #pragma omp parallel for schedule( static )
+ for( Index r = 0 ; r < MCs.size() ; ++r )
+  MCs[ r ].set_dual( d[ MCArc[ r ] ] );
+
+ for( auto i : HybArcs )
+  hyb_block( i )->set_dual( d[ i ] );
+ }
+
+/*--------------------------------------------------------------------------*/
+
+void MMCFBlock::prolong_flows( double * x ) const
+{
+ if( CrsNode.empty() )
+  throw( std::logic_error(
+		     "MMCFBlock::prolong_flows: not a coarse instance" ) );
+
+ std::vector< double > xc( std::size_t( NComm ) * NArcs );
+ get_all_flows( xc.data() );
+
+ const Index nf = CrsComm.size();
+ const Index mf = CrsArc.size();
+
+ #pragma omp parallel for schedule( dynamic )
+ for( Index k = 0 ; k < nf ; ++k ) {
+  double * const xk = x + std::size_t( k ) * mf;
+  const Index q = CrsComm[ k ];
+  if( q == Inf< Index >() ) {
+   std::fill( xk , xk + mf , double( 0 ) );
+   continue;
+   }
+
+  const double * const xq = xc.data() + std::size_t( q ) * NArcs;
+  const double w = CrsCommW[ k ];
+  for( Index i = 0 ; i < mf ; ++i ) {
+   const Index a = CrsArc[ i ];
+   xk[ i ] = a < Inf< Index >() ? w * CrsArcW[ i ] * xq[ a ] : 0;
+   }
+  }
+ }
+
+/*--------------------------------------------------------------------------*/
+
+void MMCFBlock::prolong_potentials( double * pi ) const
+{
+ if( CrsNode.empty() )
+  throw( std::logic_error(
+		"MMCFBlock::prolong_potentials: not a coarse instance" ) );
+
+ std::vector< double > pc( std::size_t( NComm ) * NNodes );
+ get_all_potentials( pc.data() );
+
+ const Index nf = CrsComm.size();
+ const Index nn = CrsNode.size();
+
+ #pragma omp parallel for schedule( static )
+ for( Index k = 0 ; k < nf ; ++k ) {
+  double * const pik = pi + std::size_t( k ) * nn;
+  const Index q = CrsComm[ k ];
+  if( q == Inf< Index >() ) {
+   std::fill( pik , pik + nn , double( 0 ) );
+   continue;
+   }
+
+  const double * const pq = pc.data() + std::size_t( q ) * NNodes;
+  for( Index v = 0 ; v < nn ; ++v )
+   pik[ v ] = pq[ CrsNode[ v ] ];
+  }
+ }
+
+/*--------------------------------------------------------------------------*/
+
+bool MMCFBlock::sp_tree( c_Subset & orgs , const Vec_CNumber & len ,
+			 Vec_CNumber & dist , Subset & pred ) const
+{
+ dist.assign( NNodes , Inf< CNumber >() );
+ pred.assign( NNodes , Inf< Index >() );
+
+ std::deque< Index > Q;
+ Vec_Bool inQ( NNodes , false );
+ Subset cnt( NNodes , 0 );  // # of times each node enters Q
+
+ for( auto org : orgs ) {
+  dist[ org ] = 0;
+  Q.push_back( org );
+  inQ[ org ] = true;
+  }
+
+ while( ! Q.empty() ) {
+  const Index u = Q.front();
+  Q.pop_front();
+  inQ[ u ] = false;
+
+  for( Index j = FSBeg[ u ] ; j < FSBeg[ u + 1 ] ; ++j ) {
+   const Index a = FSArc[ j ];
+   if( len[ a ] == Inf< CNumber >() )
+    continue;
+
+   const Index v = Endn[ a ] - StrtNme;
+   const CNumber nd = dist[ u ] + len[ a ];
+   if( nd >= dist[ v ] )
+    continue;
+
+   dist[ v ] = nd;
+   pred[ v ] = a;
+   if( inQ[ v ] )
+    continue;
+
+   if( ++cnt[ v ] > NNodes )  // a negative cycle
+    return( false );
+
+   if( ( ! Q.empty() ) && ( nd < dist[ Q.front() ] ) )
+    Q.push_front( v );        // small label first
+   else
+    Q.push_back( v );
+   inQ[ v ] = true;
+   }
+  }
+
+ return( true );
+
+ }  // end( MMCFBlock::sp_tree )
+
+/*--------------------------------------------------------------------------*/
+/*------------------- METHODS FOR MODIFYING THE MMCFBlock ------------------*/
+/*--------------------------------------------------------------------------*/
+
+void MMCFBlock::chg_costs( Index k , c_Vec_CNumber_it NCost , Range rng ,
+			   ModParam issueMod , ModParam issueAMod )
+{
+ if( k >= NComm )
+  throw( std::invalid_argument( "MMCFBlock::chg_costs: invalid commodity " +
+				std::to_string( k ) ) );
+
+ rng.second = std::min( rng.second , NArcs );
+ if( rng.second <= rng.first )
+  return;
+
+ if( not_dry_run( issueMod ) ) {
+  if( ( AR & HasVar ) && is_trivial( k ) &&
+      std::any_of( NCost , NCost + ( rng.second - rng.first ) ,
+		   []( CNumber c ) { return( c < 0 ); } ) )
+   throw( std::logic_error(
+		  "MMCFBlock::chg_costs: trivial commodity made non-trivial" ) );
+
+  // in the knapsack formulation, the new costs may change the bound on
+  // the flow of k (if PreProcess() has not been called), and with it the
+  // scales: check that all this can be represented before changing C[ k ]
+  const bool knp = ( AR & HasVar ) && ( AR & KnapsackRelaxation ) &&
+                   ( ! is_trivial( k ) );
+  FNumber mf = 0;
+  if( knp ) {
+   Vec_CNumber NCk( C[ k ] );
+   std::copy( NCost , NCost + ( rng.second - rng.first ) ,
+	      NCk.begin() + rng.first );
+   mf = PPDone ? MaxFlwK[ k ]
+               : knp_max_flow( NCk , U[ k ] ,
+			       B.empty() ? Vec_FNumber() : B[ k ].get() );
+   chk_knapsack_commodity( k2p( k ) , NCk , U[ k ] , mf ,
+			   "MMCFBlock::chg_costs" );
+   }
+
+  // the previous costs are needed by the knapsack formulation
+  Vec_CNumber OCost( C[ k ].begin() + rng.first ,
+		     C[ k ].begin() + rng.second );
+  std::copy( NCost , NCost + ( rng.second - rng.first ) ,
+	     C[ k ].mut().begin() + rng.first );
+
+  if( ! ( AR & HasVar ) )  // there is no formulation: this may change
+   find_trivial_commodities();  // which commodities are trivial
+  else
+  if( ! is_trivial( k ) ) {
+   const Index h = k2p( k );
+
+   if( AR & PathFormulation )
+    chg_path_costs( h , rng , OCost , issueAMod );
+   else
+   if( ! ( AR & KnapsackRelaxation ) ) {
+    if( v_Block[ h ] ) {  // else, it will be constructed with the new data
+     auto MCFb = static_cast< MCFBlock * >( v_Block[ h ] );
+     if( LgrLmb.empty() )
+      MCFb->chg_costs( NCost , rng , issueMod , issueAMod );
+     else {  // the MCFBlock has the Lagrangian costs
+      Vec_CNumber rc( C[ k ].begin() + rng.first ,
+		      C[ k ].begin() + rng.second );
+      for( Index j = rng.first ; j < rng.second ; ++j )
+       rc[ j - rng.first ] += LgrLmb[ j ];
+      MCFb->chg_costs( rc.cbegin() , rng , issueMod , issueAMod );
+      }
+     }
+    }
+   else {
+    knp_set_max_flow( h , mf , issueAMod );
+    for( Index j = rng.first ; j < rng.second ; ++j ) {
+     const CNumber cj = C[ k ][ j ];
+     const CNumber oj = OCost[ j - rng.first ];
+     if( cj == oj )  // unchanged, a new scale is set by knp_set_max_flow()
+      continue;
+     const auto t = knp_item( h , j );
+     if( t == Inf< Index >() )  // commodity k can not use arc j (checked)
+      continue;
+
+     auto BKb = static_cast< BinaryKnapsackBlock * >( v_Block[ j ] );
+     if( cj == Inf< CNumber >() ) {  // close the arc
+      if( oj < Inf< CNumber >() )
+       BKb->fix_x( 0 , t , issueAMod );
+      continue;
+      }
+
+     if( oj == Inf< CNumber >() )   // reopen the arc
+      BKb->unfix_x( t , issueAMod );
+     BKb->chg_profit( cj * KnpScl[ j ][ t ] , t , issueAMod );
+     }
+    }
+   }
+  }
+
+ if( issue_pmod( issueMod ) )
+  add_Modification( std::make_shared< MMCFBlockRngdMod >(
+				     this , MMCFBlockMod::eChgCost , k , rng ) ,
+		    Observer::par2chnl( issueMod ) );
+
+ }  // end( MMCFBlock::chg_costs )
+
+/*--------------------------------------------------------------------------*/
+
+void MMCFBlock::set_lagrangian_costs( const double * lambda ,
+				      ModParam issueMod , ModParam issueAMod )
+{
+ if( AR & ( KnapsackRelaxation | PathFormulation | HybridFormulation ) )
+  throw( std::logic_error(
+	    "MMCFBlock::set_lagrangian_costs: not the flow formulation" ) );
+
+ // the arcs whose multiplier, and therefore reduced cost, changes- - - - - -
+
+ Subset chg;
+ if( LgrLmb.empty() ) {
+  if( ! lambda )  // nothing was there, nothing is there
+   return;
+  LgrLmb.assign( NArcs , 0 );
+  }
+
+ chg.reserve( NArcs );
+ for( Index i = 0 ; i < NArcs ; ++i )
+  if( ( lambda ? lambda[ i ] : 0 ) != LgrLmb[ i ] )
+   chg.push_back( i );
+
+ if( lambda )
+  std::copy( lambda , lambda + NArcs , LgrLmb.begin() );
+ else
+  LgrLmb.assign( NArcs , 0 );
+
+ const bool all = ( chg.size() == NArcs );
+
+ // push the reduced costs into the MCFBlock- - - - - - - - - - - - - - - - -
+ // one cost change per MCFBlock, each computing its own reduced costs,
+ // in parallel (add_Modification() being thread-safe) unless in out-of-core
+ // mode, where the commodities must be paged in one at a time; the
+ // MCFBlock not constructed yet (if any) will be constructed with the
+ // reduced costs
+
+ if( ( AR & HasVar ) && ( ! chg.empty() ) ) {
+  const Index nf = get_NFrmlK();
+  const CNumber * const lmb = LgrLmb.data();
+  #pragma omp parallel if( ! OOCMap )
+  {
+   Vec_CNumber rc( chg.size() );
+   #pragma omp for schedule( dynamic )
+   for( Index h = 0 ; h < nf ; ++h ) {
+    auto MCFb = static_cast< MCFBlock * >( v_Block[ h ] );
+    if( ! MCFb )
+     continue;
+
+    ooc_touch( p2k( h ) );
+    const CNumber * const ck = C[ p2k( h ) ].data();
+    CNumber * const rck = rc.data();
+    if( all ) {
+     #pragma omp simd
+     for( Index i = 0 ; i < NArcs ; ++i )
+      rck[ i ] = ck[ i ] + lmb[ i ];
+     MCFb->chg_costs( rc.cbegin() , Range( 0 , NArcs ) , issueMod ,
+		      issueAMod );
+     }
+    else {
+     const Index * const ci = chg.data();
+     #pragma omp simd
+     for( Index t = 0 ; t < chg.size() ; ++t )
+      rck[ t ] = ck[ ci[ t ] ] + lmb[ ci[ t ] ];
+     MCFb->chg_costs( rc.cbegin() , Subset( chg ) , true , issueMod ,
+		      issueAMod );
+     }
+    }
+   }
+  }
+
+ if( ! lambda )
+  LgrLmb.clear();
+
+ }  // end( MMCFBlock::set_lagrangian_costs )
+
+/*--------------------------------------------------------------------------*/
+
+double MMCFBlock::lagrangian_oracle( const double * mult , double * g ,
+				     ModParam issueMod , ModParam issueAMod )
+{
+ if( ! ( ( AR & HasVar ) && ( AR & HasMutual ) ) ||
+     ( AR & ( PathFormulation | HybridFormulation ) ) )
+  throw( std::logic_error(
+   "MMCFBlock::lagrangian_oracle: no flow or knapsack formulation" ) );
+
+ const Index NF = get_NFrmlK();
+ double f = 0;
+
+ if( ! ( AR & KnapsackRelaxation ) ) {
+  // flow formulation: relax MCs- - - - - - - - - - - - - - - - - - - - - - -
+  // only the arcs with a row in MCs have a multiplier; the Lagrangian costs
+  // are only installed in the MCFBlock during the call, the previous ones
+  // being restored afterwards (also if anything throws)
+
+  Vec_CNumber lmb( NArcs , 0 );
+  for( auto i : MCArc ) {
+   lmb[ i ] = mult[ i ];
+   f -= mult[ i ] * UTot[ i ];
+   }
+
+  for( Index h = 0 ; h < NF ; ++h )  // construct all the MCFBlock, if lazy
+   mcf_block( h );
+
+  const Vec_CNumber OLmb( LgrLmb );
+  // not a Vec_Bool, since it is written in parallel
+  std::vector< char > ok( NF , true );
+  std::fill( g , g + NArcs , double( 0 ) );
+
+  try {
+   set_lagrangian_costs( lmb.data() , issueMod , issueAMod );
+
+   // in out-of-core mode the commodities must be paged in one at a time
+   #pragma omp parallel if( ! OOCMap )
+   {
+    Vec_FNumber fk( NArcs );
+    Vec_FNumber gt( NArcs , 0 );
+    double ft = 0;
+    #pragma omp for schedule( dynamic )
+    for( Index h = 0 ; h < NF ; ++h ) {
+     if( ! ( ok[ h ] = solve_sub_Block( v_Block[ h ] ) ) )
+      continue;
+     const Index k = p2k( h );
+     ooc_touch( k );
+     get_local_flow( fk , k );
+     for( Index i = 0 ; i < NArcs ; ++i )
+      if( fk[ i ] ) {
+       ft += ( C[ k ][ i ] + lmb[ i ] ) * fk[ i ];
+       gt[ i ] += fk[ i ];
+       }
+     }
+
+    #pragma omp critical
+    {
+     f += ft;
+     for( Index i = 0 ; i < NArcs ; ++i )
+      g[ i ] += gt[ i ];
+     }
+    }
+   }
+  catch( ... ) {
+   set_lagrangian_costs( OLmb.empty() ? nullptr : OLmb.data() , issueMod ,
+			 issueAMod );
+   throw;
+   }
+
+  set_lagrangian_costs( OLmb.empty() ? nullptr : OLmb.data() , issueMod ,
+			issueAMod );
+
+  for( Index h = 0 ; h < NF ; ++h )
+   if( ! ok[ h ] )
+    throw( std::logic_error( "MMCFBlock::lagrangian_oracle: sub-Block " +
+			     std::to_string( h ) + " not solved" ) );
+
+  // the subgradient is 0 on the arcs without a row in MCs, which have no
+  // multiplier (their UTot may have been squeezed by PreProcess())
+  for( Index i = 0 ; i < NArcs ; ++i )
+   g[ i ] = mc_row( i ) < MCs.size() ? g[ i ] - UTot[ i ] : 0;
+
+  return( f );
+  }
+
+ // knapsack formulation: relax FCs- - - - - - - - - - - - - - - - - - - - -
+ // with the deficit convention inflow - outflow = B, i.e., the term
+ // pi^k ( B[ k ] + outflow - inflow ), as in reduced_cost_fixing(): each
+ // item of commodity k on arc j gets the cost ( C[ k ][ j ] + pi^k at the
+ // tail - pi^k at the head ) times its scale, and the original profits
+ // are restored afterwards; the items closed after the construction (fixed
+ // to 0, with infinite cost) are left alone, as in knp_rescale()
+
+ for( Index h = 0 ; h < NF ; ++h ) {
+  const Index k = p2k( h );
+  ooc_touch( k );
+  const double * const pik = mult + std::size_t( k ) * NNodes;
+  for( Index n = 0 ; n < NNodes ; ++n )
+   f += pik[ n ] * B[ k ][ n ];
+  }
+
+ if( has_continuous_knapsacks() )  // no need to go through the Solver
+  f += solve_continuous_knapsacks( mult );
+ else {
+  // the costs of the items, so that the parallel loop does not read C[]
+  knp_gather_costs();
+  std::vector< char > ok( NArcs , true );
+
+  #pragma omp parallel
+  {
+   double ft = 0;
+   #pragma omp for schedule( dynamic , 16 )
+   for( Index j = 0 ; j < NArcs ; ++j ) {
+    auto BKb = static_cast< BinaryKnapsackBlock * >( v_Block[ j ] );
+    const auto & itm = KnpItm[ j ];
+    const auto & scl = KnpScl[ j ];
+    const Index tl = Startn[ j ] - StrtNme;
+    const Index hd = Endn[ j ] - StrtNme;
+
+    const auto & cst = KnpCst[ j ];
+
+    Vec_CNumber prf( itm.size() );
+    for( Index t = 0 ; t < itm.size() ; ++t ) {
+     if( cst[ t ] == Inf< CNumber >() )  // a closed item
+      continue;
+     const double * const pik = mult + std::size_t( p2k( itm[ t ] ) ) * NNodes;
+     prf[ t ] = ( cst[ t ] + pik[ tl ] - pik[ hd ] ) * scl[ t ];
+     BKb->chg_profit( prf[ t ] , t , issueAMod );
+     }
+
+    if( ( ok[ j ] = solve_sub_Block( BKb ) ) ) {
+     for( Index t = 0 ; t < itm.size() ; ++t )
+      if( cst[ t ] < Inf< CNumber >() )
+       ft += prf[ t ] * BKb->get_x( t );
+     if( has_design() )
+      ft += F[ j ] * BKb->get_x( itm.size() );
+     }
+
+    for( Index t = 0 ; t < itm.size() ; ++t )
+     if( cst[ t ] < Inf< CNumber >() )
+      BKb->chg_profit( cst[ t ] * scl[ t ] , t , issueAMod );
+    }
+
+   #pragma omp critical
+   f += ft;
+   }
+
+  for( Index j = 0 ; j < NArcs ; ++j )
+   if( ! ok[ j ] )
+    throw( std::logic_error( "MMCFBlock::lagrangian_oracle: knapsack " +
+			     std::to_string( j ) + " not solved" ) );
+  }
+
+ // the subgradient: B + outflow - inflow, the violation of the flow
+ // constraints with the deficit convention- - - - - - - - - - - - - - - -
+
+ std::fill( g , g + std::size_t( NComm ) * NNodes , double( 0 ) );
+ for( Index j = 0 ; j < NArcs ; ++j ) {
+  if( Startn[ j ] == Endn[ j ] )
+   continue;
+  auto BKb = static_cast< BinaryKnapsackBlock * >( v_Block[ j ] );
+  const auto & itm = KnpItm[ j ];
+  for( Index t = 0 ; t < itm.size() ; ++t ) {
+   const double x = KnpScl[ j ][ t ] * BKb->get_x( t );
+   double * const gk = g + std::size_t( p2k( itm[ t ] ) ) * NNodes;
+   gk[ Startn[ j ] - StrtNme ] += x;
+   gk[ Endn[ j ] - StrtNme ] -= x;
+   }
+  }
+
+ for( Index h = 0 ; h < NF ; ++h ) {
+  const Index k = p2k( h );
+  ooc_touch( k );
+  double * const gk = g + std::size_t( k ) * NNodes;
+  for( Index n = 0 ; n < NNodes ; ++n )
+   gk[ n ] += B[ k ][ n ];
+  }
+
+ return( f );
+
+ }  // end( MMCFBlock::lagrangian_oracle )
+
+/*--------------------------------------------------------------------------*/
+
+double MMCFBlock::solve_continuous_knapsacks( const double * pi )
+{
+ if( ! has_continuous_knapsacks() )
+  throw( std::logic_error(
+   "MMCFBlock::solve_continuous_knapsacks: no continuous knapsacks" ) );
+
+ // the costs of the items, contiguous for each arc, so that the parallel
+ // loop does not read C[] (which may be paged out)
+ knp_gather_costs();
+
+ double f = 0;
+
+ #pragma omp parallel
+ {
+  Vec_CNumber rc;  // the cost per unit of weight of each item
+  std::vector< std::size_t > off;  // the offset in pi of each item
+  Subset ord;      // the items with negative cost, by increasing cost
+  double ft = 0;
+
+  #pragma omp for schedule( dynamic , 16 )
+  for( Index j = 0 ; j < NArcs ; ++j ) {
+   auto BKb = static_cast< BinaryKnapsackBlock * >( v_Block[ j ] );
+   const auto & itm = KnpItm[ j ];
+   const auto & scl = KnpScl[ j ];
+   const Index nt = itm.size();
+
+   // the reduced costs, vectorized over the items- - - - - - - - - - - - -
+   rc.assign( KnpCst[ j ].begin() , KnpCst[ j ].end() );
+
+   if( pi && ( Startn[ j ] != Endn[ j ] ) ) {
+    off.resize( nt );
+    for( Index t = 0 ; t < nt ; ++t )
+     off[ t ] = std::size_t( p2k( itm[ t ] ) ) * NNodes;
+
+    const double * const pt = pi + ( Startn[ j ] - StrtNme );
+    const double * const ph = pi + ( Endn[ j ] - StrtNme );
+    const std::size_t * const o = off.data();
+    CNumber * const r = rc.data();
+    #pragma omp simd
+    for( Index t = 0 ; t < nt ; ++t )
+     r[ t ] += pt[ o[ t ] ] - ph[ o[ t ] ];
+    }
+
+   // sort the profitable items and fill the capacity- - - - - - - - - - - -
+   ord.clear();
+   for( Index t = 0 ; t < nt ; ++t ) {
+    BKb->get_Var( t )->set_value( 0 );
+    if( rc[ t ] < 0 )  // closed items have Inf cost
+     ord.push_back( t );
+    }
+
+   std::sort( ord.begin() , ord.end() ,
+	      [ & rc ]( Index a , Index b ) { return( rc[ a ] < rc[ b ] ); } );
+
+   FNumber res = UTot[ j ];
+   for( auto t : ord ) {
+    if( res <= 0 )
+     break;
+    const double x = std::min( double( 1 ) , res / scl[ t ] );
+    BKb->get_Var( t )->set_value( x );
+    res -= x * scl[ t ];
+    ft += rc[ t ] * scl[ t ] * x;
+    }
+   }
+
+  #pragma omp critical
+  f += ft;
+  }
+
+ return( f );
+
+ }  // end( MMCFBlock::solve_continuous_knapsacks )
+
+/*--------------------------------------------------------------------------*/
+
+double MMCFBlock::shortest_path_bound( double * pi )
+{
+ if( pi )
+  std::fill( pi , pi + std::size_t( NComm ) * NNodes , double( 0 ) );
+
+ // group the commodities that can share the same shortest path tree: - - -
+ // same origins and same costs- - - - - - - - - - - - - - - - - - - - - - -
+
+ std::vector< Subset > grps;             // the commodities in each group
+ std::vector< Subset > grporg;           // the origins of each group
+ std::map< Subset , Subset > byorg;      // the groups with given origins
+ for( Index k = 0 ; k < NComm ; ++k ) {
+  if( is_trivial( k ) )
+   continue;
+
+  ooc_touch( k );
+  Subset org;
+  for( Index n = 0 ; n < NNodes ; ++n )
+   if( B[ k ][ n ] < 0 )
+    org.push_back( n );
+
+  auto & gs = byorg[ org ];
+  auto g = gs.begin();
+  for( ; g != gs.end() ; ++g ) {
+   const Index k0 = grps[ *g ].front();
+   if( C[ k0 ].is_resident() && ( C[ k0 ] == C[ k ] ) )
+    break;
+   }
+
+  if( g != gs.end() )
+   grps[ *g ].push_back( k );
+  else {
+   gs.push_back( grps.size() );
+   grps.push_back( Subset( 1 , k ) );
+   grporg.push_back( std::move( org ) );
+   }
+  }
+
+ // one shortest path tree per group - - - - - - - - - - - - - - - - - - - -
+ // in out-of-core mode the commodities must be paged in one at a time
+
+ const Index ng = grps.size();
+ double lb = 0;
+ bool negcyc = false;
+
+ #pragma omp parallel if( ! OOCMap )
+ {
+  Vec_CNumber len;
+  Vec_CNumber dist;
+  Subset pred;
+  double lbt = 0;
+  bool nct = false;
+
+  #pragma omp for schedule( dynamic )
+  for( Index g = 0 ; g < ng ; ++g ) {
+   const Index k0 = grps[ g ].front();
+   ooc_touch( k0 );
+   len.assign( C[ k0 ].begin() , C[ k0 ].end() );
+   if( ! sp_tree( grporg[ g ] , len , dist , pred ) ) {
+    nct = true;
+    continue;
+    }
+
+   for( auto k : grps[ g ] ) {
+    ooc_touch( k );
+    const auto & Bk = B[ k ];
+    for( Index n = 0 ; n < NNodes ; ++n )
+     if( Bk[ n ] > 0 )
+      lbt += dist[ n ] < Inf< CNumber >() ? dist[ n ] * Bk[ n ]
+                                         : Inf< double >();
+
+    if( pi ) {
+     double * const pik = pi + std::size_t( k ) * NNodes;
+     for( Index n = 0 ; n < NNodes ; ++n )
+      pik[ n ] = dist[ n ] < Inf< CNumber >() ? - dist[ n ] : 0;
+     }
+    }
+   }
+
+  #pragma omp critical
+  {
+   lb += lbt;
+   negcyc = negcyc || nct;
+   }
+  }
+
+ return( negcyc ? - Inf< double >() : lb );
+
+ }  // end( MMCFBlock::shortest_path_bound )
+
+/*--------------------------------------------------------------------------*/
+
+MMCFBlock::SolutionEval MMCFBlock::evaluate_solution( const double * x ,
+						      const double * y ,
+						      Index topn )
+{
+ std::vector< double > xb;
+ if( ! x ) {
+  xb.resize( std::size_t( NComm ) * NArcs );
+  get_all_flows( xb.data() );
+  x = xb.data();
+  }
+
+ const bool dsgn = has_design();
+ if( ! dsgn )
+  y = nullptr;
+
+ SolutionEval ev{};
+ std::vector< double > tot( NArcs , 0 );  // total flow on each arc
+ std::vector< double > av( NArcs , 0 );   // violation of each arc
+ std::vector< double > nv( NNodes , 0 );  // violation of each node
+
+ // one pass per commodity: objective, flow bounds and flow conservation- -
+ // in out-of-core mode the commodities must be paged in one at a time
+
+ #pragma omp parallel if( ! OOCMap )
+ {
+  std::vector< double > tott( NArcs , 0 );
+  std::vector< double > avt( NArcs , 0 );
+  std::vector< double > nvt( NNodes , 0 );
+  std::vector< double > r( NNodes );
+  double ot = 0 , sic = 0 , mic = 0 , sfc = 0 , mfc = 0;
+
+  #pragma omp for schedule( dynamic )
+  for( Index k = 0 ; k < NComm ; ++k ) {
+   ooc_touch( k );
+   const double * const xk = x + std::size_t( k ) * NArcs;
+   const CNumber * const ck = C[ k ].data();
+   const FNumber * const uk = U[ k ].data();
+   double * const tp = tott.data();
+   double * const ap = avt.data();
+
+   #pragma omp simd reduction( + : ot , sic ) reduction( max : mic )
+   for( Index i = 0 ; i < NArcs ; ++i ) {
+    const double xi = xk[ i ];
+    tp[ i ] += xi;
+    const bool cls = ( ck[ i ] == Inf< CNumber >() );
+    if( ! cls )
+     ot += ck[ i ] * xi;
+    double ub = cls ? 0 : uk[ i ];
+    if( y )
+     ub = y[ i ] > 0 ? ub * y[ i ] : 0;
+    const double v = std::max( std::max( - xi , xi - ub ) , double( 0 ) );
+    ap[ i ] += v;
+    sic += v;
+    mic = std::max( mic , v );
+    }
+
+   const auto & Bk = B[ k ];
+   for( Index n = 0 ; n < NNodes ; ++n )
+    r[ n ] = - Bk[ n ];
+   for( Index i = 0 ; i < NArcs ; ++i )
+    if( xk[ i ] ) {
+     r[ Endn[ i ] - StrtNme ] += xk[ i ];
+     r[ Startn[ i ] - StrtNme ] -= xk[ i ];
+     }
+   for( Index n = 0 ; n < NNodes ; ++n ) {
+    const double v = std::abs( r[ n ] );
+    nvt[ n ] += v;
+    sfc += v;
+    mfc = std::max( mfc , v );
+    }
+   }
+
+  #pragma omp critical
+  {
+   for( Index i = 0 ; i < NArcs ; ++i ) {
+    tot[ i ] += tott[ i ];
+    av[ i ] += avt[ i ];
+    }
+   for( Index n = 0 ; n < NNodes ; ++n )
+    nv[ n ] += nvt[ n ];
+   ev.Obj += ot;
+   ev.SumIC += sic;
+   ev.MaxIC = std::max( ev.MaxIC , mic );
+   ev.SumFC += sfc;
+   ev.MaxFC = std::max( ev.MaxFC , mfc );
+   }
+  }
+
+ // the mutual capacities and the fixed costs- - - - - - - - - - - - - - - -
+
+ for( Index i = 0 ; i < NArcs ; ++i ) {
+  double ut = UTot[ i ];
+  if( y )
+   ut = y[ i ] > 0 ? ut * y[ i ] : 0;
+  const double v = std::max( tot[ i ] - ut , double( 0 ) );
+  av[ i ] += v;
+  ev.SumMC += v;
+  ev.MaxMC = std::max( ev.MaxMC , v );
+  if( dsgn )
+   ev.Obj += F[ i ] * ( y ? y[ i ] : ( tot[ i ] > 0 ? 1 : 0 ) );
+  }
+
+ // the most violated arcs and nodes- - - - - - - - - - - - - - - - - - - -
+
+ auto top = [ topn ]( const std::vector< double > & viol ,
+		      std::vector< std::pair< Index , double > > & res ) {
+  for( Index j = 0 ; j < viol.size() ; ++j )
+   if( viol[ j ] > 0 )
+    res.push_back( std::make_pair( j , viol[ j ] ) );
+  auto mid = res.begin() + std::min( Index( res.size() ) , topn );
+  std::partial_sort( res.begin() , mid , res.end() ,
+		     []( const std::pair< Index , double > & a ,
+			 const std::pair< Index , double > & b ) {
+		      return( a.second > b.second ); } );
+  res.erase( mid , res.end() );
+  };
+
+ top( av , ev.TopArcs );
+ top( nv , ev.TopNodes );
+
+ return( ev );
+
+ }  // end( MMCFBlock::evaluate_solution )
+
+/*--------------------------------------------------------------------------*/
+
+double MMCFBlock::slope_scaling( Index maxit , double eps , double * x ,
+				 double * y , ModParam issueMod ,
+				 ModParam issueAMod )
+{
+ if( ( ! ( AR & HasVar ) ) ||
+     ( AR & ( KnapsackRelaxation | PathFormulation | HybridFormulation ) ) )
+  throw( std::logic_error( "MMCFBlock::slope_scaling: no flow formulation"
+			   ) );
+
+ const Index NF = get_NFrmlK();
+ for( Index h = 0 ; h < NF ; ++h )  // construct all the MCFBlock, if lazy
+  mcf_block( h );
+
+ const bool dsgn = has_design();
+ const Vec_CNumber OLmb( LgrLmb );  // restored at the end
+
+ // the initial slopes, and the scale of the penalties - - - - - - - - - - -
+ // the penalty of one unit of relative violation is the average cost
+
+ Vec_CNumber rho( NArcs , 0 );
+ Vec_CNumber pen( NArcs , 0 );
+ Vec_CNumber lmb( NArcs );
+ if( dsgn )
+  for( Index i = 0 ; i < NArcs ; ++i )
+   rho[ i ] = ( ( UTot[ i ] > 0 ) && ( UTot[ i ] < Inf< FNumber >() ) )
+              ? F[ i ] / UTot[ i ] : F[ i ];
+
+ double cbar = 0;
+ std::size_t nc = 0;
+ for( Index k = 0 ; k < NComm ; ++k ) {
+  ooc_touch( k );
+  for( auto c : C[ k ] )
+   if( c < Inf< CNumber >() ) {
+    cbar += std::abs( c );
+    ++nc;
+    }
+  }
+ if( cbar > 0 )
+  cbar /= nc;
+ else
+  cbar = 1;
+
+ // main loop- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+ std::vector< double > xb( std::size_t( NComm ) * NArcs );
+ std::vector< double > tot( NArcs );
+ std::vector< double > ptot;
+ // not a Vec_Bool, since it is written in parallel
+ std::vector< char > ok( NF );
+ double best = Inf< double >();
+
+ // the original costs are restored also if anything throws
+ try {
+  for( Index it = 0 ; it < maxit ; ++it ) {
+   for( Index i = 0 ; i < NArcs ; ++i )
+    lmb[ i ] = rho[ i ] + pen[ i ];
+   set_lagrangian_costs( lmb.data() , issueMod , issueAMod );
+
+   #pragma omp parallel for schedule( dynamic )
+   for( Index h = 0 ; h < NF ; ++h )
+    ok[ h ] = solve_sub_Block( v_Block[ h ] );
+
+   for( Index h = 0 ; h < NF ; ++h )
+    if( ! ok[ h ] )
+     throw( std::logic_error( "MMCFBlock::slope_scaling: sub-Block " +
+			      std::to_string( h ) + " not solved" ) );
+
+   // round to the design opening the arcs with flow, and evaluate- - - - -
+
+   get_all_flows( xb.data() );
+   std::fill( tot.begin() , tot.end() , double( 0 ) );
+   for( Index k = 0 ; k < NComm ; ++k ) {
+    const double * const xk = xb.data() + std::size_t( k ) * NArcs;
+    for( Index i = 0 ; i < NArcs ; ++i )
+     tot[ i ] += xk[ i ];
+    }
+
+   const auto ev = evaluate_solution( xb.data() , nullptr , 0 );
+   const bool feas = ( ev.MaxFC <= eps ) && ( ev.MaxIC <= eps ) &&
+                     ( ev.MaxMC <= eps );
+   if( feas && ( ev.Obj < best ) ) {
+    best = ev.Obj;
+    if( x )
+     std::copy( xb.begin() , xb.end() , x );
+    if( y )
+     for( Index i = 0 ; i < NArcs ; ++i )
+      y[ i ] = tot[ i ] > 0 ? 1 : 0;
+    }
+
+   if( feas && ( tot == ptot ) )  // the linearization is stable
+    break;
+   ptot = tot;
+
+   // update the slopes and the penalties- - - - - - - - - - - - - - - - - -
+   // an arc with no flow keeps its previous slope
+
+   for( Index i = 0 ; i < NArcs ; ++i ) {
+    if( dsgn && ( tot[ i ] > eps ) )
+     rho[ i ] = F[ i ] / tot[ i ];
+    if( tot[ i ] > UTot[ i ] + eps )
+     pen[ i ] += cbar * ( tot[ i ] - UTot[ i ] ) /
+                 std::max( UTot[ i ] , FNumber( 1 ) );
+    }
+   }
+  }
+ catch( ... ) {
+  set_lagrangian_costs( OLmb.empty() ? nullptr : OLmb.data() , issueMod ,
+			issueAMod );
+  throw;
+  }
+
+ set_lagrangian_costs( OLmb.empty() ? nullptr : OLmb.data() , issueMod ,
+		       issueAMod );
+ return( best );
+
+ }  // end( MMCFBlock::slope_scaling )
+
+/*--------------------------------------------------------------------------*/
+
+Block::Subset MMCFBlock::reduced_cost_fixing( double ub , const double * pi ,
+					      double * lb ,
+					      ModParam issueMod ,
+					      ModParam issueAMod )
+{
+ // the potentials of the formulation have the opposite convention
+ std::vector< double > pib;
+ if( ! pi ) {
+  pib.resize( std::size_t( NComm ) * NNodes );
+  get_all_potentials( pib.data() );
+  for( auto & p : pib )
+   p = - p;
+  pi = pib.data();
+  }
+
+ // the constant term of L - - - - - - - - - - - - - - - - - - - - - - - - -
+
+ double L = 0;
+ for( Index k = 0 ; k < NComm ; ++k ) {
+  ooc_touch( k );
+  const double * const pik = pi + std::size_t( k ) * NNodes;
+  const auto & Bk = B[ k ];
+  for( Index n = 0 ; n < NNodes ; ++n )
+   L += pik[ n ] * Bk[ n ];
+  }
+
+ // the continuous knapsack of each arc- - - - - - - - - - - - - - - - - - -
+ // the arcs are taken in blocks, for each of which the reduced costs and
+ // the bounds of the items are gathered (arc-major) with one pass over the
+ // commodities, so that the buffers have a bounded size; gap[ i ] is what
+ // forcing arc i open adds to L, -1 if it is closed
+
+ const bool hasF = ( F.size() == NArcs );
+ std::vector< double > gap( NArcs );
+ Index nb = ( 1 << 20 ) / std::max( NComm , Index( 1 ) );
+ nb = std::max( std::min( nb , NArcs ) , Index( 1 ) );
+ std::vector< double > rcm( std::size_t( nb ) * NComm );
+ std::vector< double > ubm( std::size_t( nb ) * NComm );
+
+ for( Index i0 = 0 ; i0 < NArcs ; i0 += nb ) {
+  const Index i1 = std::min( i0 + nb , NArcs );
+
+  for( Index k = 0 ; k < NComm ; ++k ) {
+   ooc_touch( k );
+   const double * const pik = pi + std::size_t( k ) * NNodes;
+   const auto & Ck = C[ k ];
+   const auto & Uk = U[ k ];
+   for( Index i = i0 ; i < i1 ; ++i ) {
+    const std::size_t p = std::size_t( i - i0 ) * NComm + k;
+    rcm[ p ] = Ck[ i ] < Inf< CNumber >()
+               ? Ck[ i ] + pik[ Startn[ i ] - StrtNme ] -
+                 pik[ Endn[ i ] - StrtNme ]
+               : Inf< double >();
+    ubm[ p ] = std::min( Uk[ i ] , UTot[ i ] );
+    }
+   }
+
+  #pragma omp parallel
+  {
+   Subset ord;
+   double Lt = 0;
+
+   #pragma omp for schedule( dynamic , 64 )
+   for( Index i = i0 ; i < i1 ; ++i ) {
+    const double * const rci = rcm.data() + std::size_t( i - i0 ) * NComm;
+    const double * const ubi = ubm.data() + std::size_t( i - i0 ) * NComm;
+
+    ord.clear();
+    bool open = false;
+    for( Index k = 0 ; k < NComm ; ++k )
+     if( rci[ k ] < Inf< double >() ) {
+      open = true;
+      if( rci[ k ] < 0 )
+       ord.push_back( k );
+      }
+
+    if( ! open ) {
+     gap[ i ] = -1;
+     continue;
+     }
+
+    std::sort( ord.begin() , ord.end() , [ rci ]( Index a , Index b ) {
+	       return( rci[ a ] < rci[ b ] ); } );
+
+    double v = hasF ? F[ i ] : 0;
+    double res = UTot[ i ];
+    for( auto k : ord ) {
+     if( res <= 0 )
+      break;
+     const double x = std::min( double( ubi[ k ] ) , res );
+     v += rci[ k ] * x;
+     res -= x;
+     }
+
+    Lt += std::min( v , double( 0 ) );
+    gap[ i ] = std::max( v , double( 0 ) );
+    }
+
+   #pragma omp critical
+   L += Lt;
+   }
+  }
+
+ if( lb )
+  *lb = L;
+
+ // close the arcs that can not be in a better solution- - - - - - - - - -
+ // only with fixed costs: otherwise gap is 0 for all the open arcs, and
+ // a rounding error in L would close all of them
+
+ Subset cls;
+ if( ( ! has_design() ) || ( L == - Inf< double >() ) )
+  return( cls );
+
+ const double tol = 1e-9 * std::max( std::abs( ub ) , double( 1 ) );
+ for( Index i = 0 ; i < NArcs ; ++i )
+  if( ( gap[ i ] >= 0 ) && ( L + gap[ i ] > ub + tol ) )
+   cls.push_back( i );
+
+ if( cls.empty() )
+  return( cls );
+
+ // one chg_costs() per commodity, on the range covering all the closed
+ // arcs, with the current costs of the arcs in between (which chg_costs()
+ // then leaves alone); the commodities not using any of them are skipped
+
+ const Range rng( cls.front() , cls.back() + 1 );
+ Vec_CNumber nc( rng.second - rng.first );
+ for( Index k = 0 ; k < NComm ; ++k ) {
+  ooc_touch( k );
+  const auto & Ck = C[ k ];
+  if( std::none_of( cls.begin() , cls.end() , [ & Ck ]( Index i ) {
+		     return( Ck[ i ] < Inf< CNumber >() ); } ) )
+   continue;
+
+  std::copy( Ck.begin() + rng.first , Ck.begin() + rng.second ,
+	     nc.begin() );
+  for( auto i : cls )
+   nc[ i - rng.first ] = Inf< CNumber >();
+  chg_costs( k , nc.cbegin() , rng , issueMod , issueAMod );
+  }
+
+ return( cls );
+
+ }  // end( MMCFBlock::reduced_cost_fixing )
+
+/*--------------------------------------------------------------------------*/
+
+Vec_CNumber MMCFBlock::mcf_costs( Index k ) const
+{
+ Vec_CNumber ck( C[ k ].begin() , C[ k ].end() );
+ if( ! LgrLmb.empty() )
+  for( Index i = 0 ; i < NArcs ; ++i )
+   ck[ i ] += LgrLmb[ i ];
+
+ return( ck );
+ }
+
+/*--------------------------------------------------------------------------*/
+
+void MMCFBlock::chg_fixed_costs( c_Vec_CNumber_it NFCost , Range rng ,
+				 ModParam issueMod , ModParam issueAMod )
+{
+ rng.second = std::min( rng.second , NArcs );
+ if( rng.second <= rng.first )
+  return;
+
+ if( not_dry_run( issueMod ) ) {
+  // the design items exist in the knapsack and hybrid formulations only if
+  // there were fixed costs when they have been constructed
+  const bool knp = ( AR & HasVar ) &&
+                   ( AR & ( KnapsackRelaxation | HybridFormulation ) );
+  const bool dsgn = has_design();
+
+  if( F.size() < NArcs )
+   F.mut().resize( NArcs , 0 );
+  std::copy( NFCost , NFCost + ( rng.second - rng.first ) ,
+	     F.mut().begin() + rng.first );
+
+  if( knp ) {
+   if( ! dsgn ) {
+    if( has_design() )
+     throw( std::logic_error(
+		   "MMCFBlock::chg_fixed_costs: no design variables" ) );
+    }
+   else
+    for( Index j = rng.first ; j < rng.second ; ++j )
+     if( AR & KnapsackRelaxation )
+      static_cast< BinaryKnapsackBlock * >( v_Block[ j ] )->chg_profit(
+				    F[ j ] , KnpItm[ j ].size() , issueAMod );
+     else
+     if( in_hybrid( j ) )
+      hyb_block( j )->chg_profit( F[ j ] , get_NFrmlK() , issueAMod );
+   }
+  }
+
+ if( issue_pmod( issueMod ) )
+  add_Modification( std::make_shared< MMCFBlockRngdMod >(
+		       this , MMCFBlockMod::eChgFCost , Inf< Index >() , rng ) ,
+		    Observer::par2chnl( issueMod ) );
+
+ }  // end( MMCFBlock::chg_fixed_costs )
+
+/*--------------------------------------------------------------------------*/
+
+void MMCFBlock::chg_mutual_capacity( c_Vec_FNumber_it NUTot , Range rng ,
+				     ModParam issueMod , ModParam issueAMod )
+{
+ rng.second = std::min( rng.second , NArcs );
+ if( rng.second <= rng.first )
+  return;
+
+ if( not_dry_run( issueMod ) ) {
+  // change the data, checking on the whole range that the formulation can
+  // represent it before modifying the formulation; in the knapsack one the
+  // bound on the flow of every commodity (if PreProcess() has not been
+  // called) depends on UTot, and with it the scales
+  Vec_FNumber OUTot( UTot.get().begin() + rng.first ,
+		     UTot.get().begin() + rng.second );
+  std::copy( NUTot , NUTot + ( rng.second - rng.first ) ,
+	     UTot.mut().begin() + rng.first );
+
+  const bool knp = ( AR & HasVar ) && ( AR & KnapsackRelaxation ) &&
+                   ( ! PPDone );
+  Vec_FNumber mf( knp ? get_NFrmlK() : 0 );
+  if( AR & HasVar )
+   try {
+    for( Index i = rng.first ; i < rng.second ; ++i )
+     chk_mutual_capacity( i , "MMCFBlock::chg_mutual_capacity" );
+
+    for( Index h = 0 ; h < mf.size() ; ++h ) {
+     const Index k = p2k( h );
+     mf[ h ] = knp_max_flow( C[ k ] , U[ k ] ,
+			     B.empty() ? Vec_FNumber() : B[ k ].get() );
+     chk_knapsack_commodity( h , C[ k ] , U[ k ] , mf[ h ] ,
+			     "MMCFBlock::chg_mutual_capacity" );
+     }
+    }
+   catch( ... ) {
+    std::copy( OUTot.begin() , OUTot.end() ,
+	       UTot.mut().begin() + rng.first );
+    throw;
+    }
+
+  if( PPDone )  // the new values are the ones PreProcess() would start from
+   std::copy( UTot.get().begin() + rng.first ,
+	      UTot.get().begin() + rng.second ,
+	      UTotOrg.begin() + rng.first );
+
+  if( AR & HasVar ) {
+   for( Index i = rng.first ; i < rng.second ; ++i )
+    upd_mutual_capacity( i , issueAMod );
+   for( Index h = 0 ; h < mf.size() ; ++h )
+    knp_set_max_flow( h , mf[ h ] , issueAMod );
+   }
+  }
+
+ if( issue_pmod( issueMod ) )
+  add_Modification( std::make_shared< MMCFBlockRngdMod >(
+			this , MMCFBlockMod::eChgUTot , Inf< Index >() , rng ) ,
+		    Observer::par2chnl( issueMod ) );
+
+ }  // end( MMCFBlock::chg_mutual_capacity )
+
+/*--------------------------------------------------------------------------*/
+
+void MMCFBlock::chg_commodity_capacity( Index k , c_Vec_FNumber_it NU ,
+					Range rng , ModParam issueMod ,
+					ModParam issueAMod )
+{
+ if( k >= NComm )
+  throw( std::invalid_argument(
+	       "MMCFBlock::chg_commodity_capacity: invalid commodity " +
+	       std::to_string( k ) ) );
+
+ rng.second = std::min( rng.second , NArcs );
+ if( rng.second <= rng.first )
+  return;
+
+ if( not_dry_run( issueMod ) ) {
+  // in the knapsack formulation, the new capacities may change the bound
+  // on the flow of k (if PreProcess() has not been called), and with it
+  // the scales: check that all this can be represented before changing U
+  const bool knp = ( AR & HasVar ) && ( AR & KnapsackRelaxation ) &&
+                   ( ! is_trivial( k ) );
+  FNumber mf = 0;
+  if( knp ) {
+   Vec_FNumber NUk( U[ k ] );
+   std::copy( NU , NU + ( rng.second - rng.first ) ,
+	      NUk.begin() + rng.first );
+   mf = PPDone ? MaxFlwK[ k ]
+               : knp_max_flow( C[ k ] , NUk ,
+			       B.empty() ? Vec_FNumber() : B[ k ].get() );
+   chk_knapsack_commodity( k2p( k ) , C[ k ] , NUk , mf ,
+			   "MMCFBlock::chg_commodity_capacity" );
+   }
+
+  std::copy( NU , NU + ( rng.second - rng.first ) ,
+	     U[ k ].mut().begin() + rng.first );
+
+  // the new values are the ones PreProcess() would start from
+  if( PPDone )
+   USqzd[ k ].erase( std::remove_if( USqzd[ k ].begin() , USqzd[ k ].end() ,
+				     [ & rng ]( const auto & p ) {
+				      return( ( p.first >= rng.first ) &&
+					      ( p.first < rng.second ) ); } ) ,
+		     USqzd[ k ].end() );
+
+  if( knp ) {
+   knp_set_max_flow( k2p( k ) , mf , issueAMod );
+   upd_commodity_capacity( k , rng , issueMod , issueAMod );
+   }
+  else
+   if( ( AR & HasVar ) && ( ! is_trivial( k ) ) ) {
+    for( Index i = rng.first ; i < rng.second ; ++i )
+     chk_commodity_capacity( k , i , "MMCFBlock::chg_commodity_capacity" );
+    upd_commodity_capacity( k , rng , issueMod , issueAMod );
+    }
+  }
+
+ if( issue_pmod( issueMod ) )
+  add_Modification( std::make_shared< MMCFBlockRngdMod >(
+				      this , MMCFBlockMod::eChgCap , k , rng ) ,
+		    Observer::par2chnl( issueMod ) );
+
+ }  // end( MMCFBlock::chg_commodity_capacity )
+
+/*--------------------------------------------------------------------------*/
+
+void MMCFBlock::chg_deficits( Index k , c_Vec_FNumber_it NDfct , Range rng ,
+			      ModParam issueMod , ModParam issueAMod )
+{
+ if( k >= NComm )
+  throw( std::invalid_argument( "MMCFBlock::chg_deficits: invalid "
+				"commodity " + std::to_string( k ) ) );
+
+ rng.second = std::min( rng.second , NNodes );
+ if( rng.second <= rng.first )
+  return;
+
+ if( not_dry_run( issueMod ) ) {
+  Vec_FNumber NBk( B[ k ] );
+  std::copy( NDfct , NDfct + ( rng.second - rng.first ) ,
+	     NBk.begin() + rng.first );
+
+  const bool frml = ( AR & HasVar ) && ( ! is_trivial( k ) );
+  if( ( AR & HasVar ) && ( ! frml ) && ( ! trivial_data( C[ k ] , NBk ) ) )
+   throw( std::logic_error(
+	       "MMCFBlock::chg_deficits: trivial commodity made non-trivial" ) );
+
+  const Index h = frml ? k2p( k ) : Inf< Index >();
+
+  // in the arc-path formulation, check that the commodity still fits - - -
+  FNumber dmd = 0;
+  if( frml && ( AR & PathFormulation ) ) {
+   Index no = 0;
+   Index nd = 0;
+   for( Index v = 0 ; v < NNodes ; ++v )
+    if( NBk[ v ] < 0 ) {
+     if( v != PathOrg[ h ] )
+      no = 2;
+     ++no;
+     }
+    else
+     if( NBk[ v ] > 0 ) {
+      if( v != PathDst[ h ] )
+       nd = 2;
+      dmd = NBk[ v ];
+      ++nd;
+      }
+
+   if( ( no || nd ) && ( ( no != 1 ) || ( nd != 1 ) ) )
+    throw( std::logic_error( "MMCFBlock::chg_deficits: origin or "
+			     "destination changed in the arc-path "
+			     "formulation" ) );
+
+   for( Index i = 0 ; i < NArcs ; ++i )
+    if( ( C[ k ][ i ] < Inf< CNumber >() ) && ( U[ k ][ i ] < dmd ) &&
+	( ! std::binary_search( PathICArc.begin() + PathICBeg[ h ] ,
+				PathICArc.begin() + PathICBeg[ h + 1 ] ,
+				i ) ) )
+     throw( std::logic_error( "MMCFBlock::chg_deficits: individual "
+			      "capacity constraint of arc " +
+			      std::to_string( i ) +
+			      " not in the formulation" ) );
+   }
+
+  // in the knapsack formulation, check that the new bound on the flow of
+  // k, and with it the scales, can be represented
+  FNumber mf = 0;
+  if( frml && ( AR & KnapsackRelaxation ) ) {
+   mf = PPDone ? MaxFlwK[ k ] : knp_max_flow( C[ k ] , U[ k ] , NBk );
+   chk_knapsack_commodity( h , C[ k ] , U[ k ] , mf ,
+			   "MMCFBlock::chg_deficits" );
+   }
+
+  B[ k ] = std::move( NBk );
+  BIsCpy.clear();
+
+  if( ! ( AR & HasVar ) )
+   find_trivial_commodities();
+  else
+  if( frml ) {
+   if( AR & PathFormulation ) {
+    PathDmd[ h ] = dmd;
+    if( AR & HasMutual )
+     PathDCs[ h ].set_both( dmd , issueAMod );
+    }
+   else
+   if( ! ( AR & KnapsackRelaxation ) ) {
+    if( v_Block[ h ] )  // else, it will be constructed with the new data
+     static_cast< MCFBlock * >( v_Block[ h ] )->chg_dfcts(
+				     B[ k ].cbegin() + rng.first , rng ,
+				     issueMod , issueAMod );
+    }
+   else {
+    if( AR & HasMutual )
+     for( Index v = rng.first ; v < rng.second ; ++v )
+      FCs[ h ][ v ].set_both( B[ k ][ v ] , issueAMod );
+
+    // the bound on the flow of k may have changed, and with it the scales
+    knp_set_max_flow( h , mf , issueAMod );
+    }
+   }
+  }
+
+ if( issue_pmod( issueMod ) )
+  add_Modification( std::make_shared< MMCFBlockRngdMod >(
+				     this , MMCFBlockMod::eChgDfct , k , rng ) ,
+		    Observer::par2chnl( issueMod ) );
+
+ }  // end( MMCFBlock::chg_deficits )
+
+/*--------------------------------------------------------------------------*/
+
+Index MMCFBlock::add_commodity( Vec_CNumber && c , Vec_FNumber && u ,
+				Vec_FNumber && b , ModParam issueMod ,
+				ModParam issueAMod )
+{
+ if( ( c.size() != NArcs ) || ( u.size() != NArcs ) || ( b.size() != NNodes ) )
+  throw( std::invalid_argument(
+		      "MMCFBlock::add_commodity: wrong commodity data size" ) );
+
+ const bool frml = AR & HasVar;
+ if( frml && ( AR & PathFormulation ) )
+  throw( std::logic_error( "MMCFBlock::add_commodity: not supported in "
+			   "the arc-path formulation" ) );
+
+ // choose the slot: that of a removed commodity, if any (preferably one
+ // still in the formulation), otherwise a new one at the end- - - - - - - -
+
+ Index k = NComm;
+ for( Index q = 0 ; q < RmvdK.size() ; ++q )
+  if( RmvdK[ q ] ) {
+   if( k == NComm )
+    k = q;
+   if( frml && ! is_trivial( q ) ) {
+    k = q;
+    break;
+    }
+   }
+
+ const bool reuse = frml && ( k < NComm ) && ( ! is_trivial( k ) );
+ const bool trvl = trivial_data( c , b );
+
+ // check that the formulation can accommodate the new commodity, before
+ // changing anything; a reused slot is in the formulation even if the new
+ // commodity is trivial - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+ FNumber mf = 0;
+ if( frml && ( reuse || ( ! trvl ) ) ) {
+  if( AR & KnapsackRelaxation ) {
+   // items can not be added: only those of a removed commodity can be used
+   if( ! reuse )
+    throw( std::logic_error( "MMCFBlock::add_commodity: no free commodity "
+			     "slot in the knapsack formulation" ) );
+   mf = knp_max_flow( c , u , b );
+   const Index h = k2p( k );
+   for( Index j = 0 ; j < NArcs ; ++j ) {
+    if( ( c[ j ] == Inf< CNumber >() ) ||
+	( std::min( { u[ j ] , UTot[ j ] , mf } ) <= 0 ) )
+     continue;
+    if( knp_item( h , j ) == Inf< Index >() )
+     throw( std::logic_error( "MMCFBlock::add_commodity: arc " +
+			      std::to_string( j ) + " is not in the "
+			      "knapsack formulation" ) );
+    if( std::min( { u[ j ] , UTot[ j ] , mf } ) >= Inf< FNumber >() )
+     throw( std::logic_error( "MMCFBlock::add_commodity: unbounded flow on "
+			      "arc " + std::to_string( j ) ) );
+    }
+   }
+  else {
+   if( ( ! reuse ) && ( ! HybArcs.empty() ) )
+    throw( std::logic_error( "MMCFBlock::add_commodity: no free commodity "
+			     "slot in the hybrid formulation" ) );
+
+   // the flow of k is only added to the existing rows of MCs: the mutual
+   // capacity constraints that are not there (because PreProcess() found
+   // them redundant) must still be so
+   if( AR & HasMutual )
+    for( Index i = 0 ; i < NArcs ; ++i ) {
+     if( ( c[ i ] == Inf< CNumber >() ) || in_hybrid( i ) ||
+	 ( mc_row( i ) < MCs.size() ) )
+      continue;
+     FNumber Ui = u[ i ];
+     for( Index h = 0 ; h < get_NFrmlK() ; ++h )
+      if( p2k( h ) != k )
+       Ui += U[ p2k( h ) ][ i ];
+     if( Ui > UTot[ i ] )
+      throw( std::logic_error( "MMCFBlock::add_commodity: constraint of "
+			       "arc " + std::to_string( i ) +
+			       " not in the formulation" ) );
+     }
+   }
+  }
+
+ if( ! not_dry_run( issueMod ) )
+  throw( std::invalid_argument(
+		"MMCFBlock::add_commodity: dry run not supported" ) );
+
+ // store the data- - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+ if( k == NComm ) {
+  if( frml && PosK.empty() ) {  // make the positions explicit
+   FrmlK.resize( NComm );
+   std::iota( FrmlK.begin() , FrmlK.end() , 0 );
+   PosK = FrmlK;
+   }
+
+  ++NComm;
+  C.push_back( std::move( c ) );
+  U.push_back( std::move( u ) );
+  B.push_back( std::move( b ) );
+  PT.push_back( kMCF );
+  ActiveK.emplace_back();
+  if( ! RmvdK.empty() )
+   RmvdK.push_back( false );
+  if( frml )
+   PosK.push_back( Inf< Index >() );
+  if( PPDone ) {
+   USqzd.emplace_back();
+   MaxFlwK.push_back( 0 );
+   }
+  }
+ else {
+  C[ k ] = std::move( c );
+  U[ k ] = std::move( u );
+  B[ k ] = std::move( b );
+  RmvdK[ k ] = false;
+  if( PPDone )
+   USqzd[ k ].clear();
+  }
+
+ // the rows are no longer known to be copies of each other
+ CIsCpy.clear();
+ UIsCpy.clear();
+ BIsCpy.clear();
+
+ if( PPDone ) {
+  const FNumber MFk = pp_max_flow( k );
+  MaxFlw += MFk - MaxFlwK[ k ];
+  MaxFlwK[ k ] = MFk;
+  }
+
+ set_ActiveK( k );
+ set_NamesK();
+
+ // update the formulation- - - - - - - - - - - - - - - - - - - - - - - - -
+
+ if( ! frml )
+  find_trivial_commodities();
+ else {
+  // the slot of a removed commodity still in the formulation must be
+  // brought back to life (arcs reopened, data reset) even if the new
+  // commodity is trivial, since it stays formulated; a trivial commodity
+  // needs nothing otherwise, not even its slot
+  if( reuse ) {
+   const Index h = k2p( k );
+   if( AR & KnapsackRelaxation ) {
+    KnpMxF[ h ] = mf;
+    for( Index j = 0 ; j < NArcs ; ++j ) {
+     const auto t = knp_item( h , j );
+     if( t == Inf< Index >() )
+      continue;
+     auto BKb = static_cast< BinaryKnapsackBlock * >( v_Block[ j ] );
+     if( C[ k ][ j ] == Inf< CNumber >() ) {
+      BKb->fix_x( 0 , t , issueAMod );
+      continue;
+      }
+     BKb->unfix_x( t , issueAMod );
+     knp_rescale( j , t , knp_scale( h , j ) , issueAMod );
+     }
+
+    if( AR & HasMutual )
+     for( Index v = 0 ; v < NNodes ; ++v )
+      FCs[ h ][ v ].set_both( B[ k ][ v ] , issueAMod );
+    }
+   else
+   if( auto MCFb = static_cast< MCFBlock * >( v_Block[ h ] ) ) {
+    for( Index i = 0 ; i < NArcs ; ++i )
+     if( MCFb->is_closed( i ) && ( C[ k ][ i ] < Inf< CNumber >() ) )
+      MCFb->open_arc( i , issueMod , issueAMod );
+    if( LgrLmb.empty() )
+     MCFb->chg_costs( C[ k ].cbegin() , Range( 0 , NArcs ) , issueMod ,
+		      issueAMod );
+    else  // the MCFBlock has the Lagrangian costs
+     MCFb->chg_costs( mcf_costs( k ).cbegin() , Range( 0 , NArcs ) ,
+		      issueMod , issueAMod );
+    MCFb->chg_ucaps( U[ k ].cbegin() , Range( 0 , NArcs ) , issueMod ,
+		     issueAMod );
+    MCFb->chg_dfcts( B[ k ].cbegin() , Range( 0 , NNodes ) , issueMod ,
+		     issueAMod );
+    for( auto i : HybArcs )
+     hyb_rescale( i , h , issueAMod );
+    }
+   }
+  else
+  if( ! trvl ) {  // a new MCFBlock, which goes before the hybrid knapsacks
+   const Index h = get_NFrmlK();
+   // when lazy, it is only constructed if the constraints need it
+   auto MCFb = ( ( AR & LazySubBlocks ) && ( ! ( AR & HasMutual ) ) )
+               ? nullptr : new_mcf_block( k );
+   v_Block.insert( v_Block.begin() + h , MCFb );
+
+   PosK[ k ] = h;
+   FrmlK.push_back( k );
+
+   if( AR & HasMutual )
+    for( Index r = 0 ; r < MCs.size() ; ++r )
+     static_cast< LinearFunction * >( MCs[ r ].get_function() )->add_variable(
+			      MCFb->i2p_x( MCArc[ r ] ) , 1 , issueAMod );
+   }
+  }
+
+ if( issue_pmod( issueMod ) )
+  add_Modification( std::make_shared< MMCFBlockRngdMod >(
+		     this , MMCFBlockMod::eAddComm , k , Range( 0 , NArcs ) ) ,
+		    Observer::par2chnl( issueMod ) );
+ return( k );
+
+ }  // end( MMCFBlock::add_commodity )
+
+/*--------------------------------------------------------------------------*/
+
+void MMCFBlock::remove_commodity( Index k , ModParam issueMod ,
+				  ModParam issueAMod )
+{
+ if( ( k >= NComm ) || is_removed( k ) )
+  throw( std::invalid_argument(
+		 "MMCFBlock::remove_commodity: invalid commodity " +
+		 std::to_string( k ) ) );
+
+ if( not_dry_run( issueMod ) ) {
+  std::fill( B[ k ].mut().begin() , B[ k ].mut().end() , 0 );
+  std::fill( C[ k ].mut().begin() , C[ k ].mut().end() , Inf< CNumber >() );
+  if( RmvdK.empty() )
+   RmvdK.assign( NComm , false );
+  RmvdK[ k ] = true;
+
+  CIsCpy.clear();
+  UIsCpy.clear();
+  BIsCpy.clear();
+
+  if( PPDone ) {
+   USqzd[ k ].clear();
+   const FNumber MFk = pp_max_flow( k );
+   MaxFlw += MFk - MaxFlwK[ k ];
+   MaxFlwK[ k ] = MFk;
+   }
+
+  set_ActiveK( k );
+  set_NamesK();
+
+  // the slot stays in the formulation, with all its flows fixed to 0- - - -
+
+  if( ! ( AR & HasVar ) )
+   find_trivial_commodities();
+  else
+  if( ! is_trivial( k ) ) {
+   const Index h = k2p( k );
+
+   if( AR & PathFormulation ) {
+    for( auto & var : PathVars[ h ] ) {
+     var.set_value( 0 );
+     var.fix( issueAMod );
+     }
+    PathDmd[ h ] = 0;
+    if( AR & HasMutual )
+     PathDCs[ h ].set_both( 0 , issueAMod );
+    path_ungroup( h );
+    }
+   else
+   if( ! ( AR & KnapsackRelaxation ) ) {
+    if( auto MCFb = static_cast< MCFBlock * >( v_Block[ h ] ) ) {
+     MCFb->chg_dfcts( B[ k ].cbegin() , Range( 0 , NNodes ) , issueMod ,
+		      issueAMod );
+     for( Index i = 0 ; i < NArcs ; ++i )
+      if( ! MCFb->is_closed( i ) )
+       MCFb->close_arc( i , issueMod , issueAMod );
+     }
+    }
+   else {
+    for( Index j = 0 ; j < NArcs ; ++j ) {
+     const auto t = knp_item( h , j );
+     if( t < Inf< Index >() )
+      static_cast< BinaryKnapsackBlock * >( v_Block[ j ] )->fix_x( 0 , t ,
+								issueAMod );
+     }
+    if( AR & HasMutual )
+     for( Index v = 0 ; v < NNodes ; ++v )
+      FCs[ h ][ v ].set_both( 0 , issueAMod );
+    }
+   }
+  }
+
+ if( issue_pmod( issueMod ) )
+  add_Modification( std::make_shared< MMCFBlockRngdMod >(
+		     this , MMCFBlockMod::eRmvComm , k , Range( 0 , NArcs ) ) ,
+		    Observer::par2chnl( issueMod ) );
+
+ }  // end( MMCFBlock::remove_commodity )
+
+/*--------------------------------------------------------------------------*/
+
+void MMCFBlock::knp_rescale( Index j , Index t , FNumber s ,
+			     ModParam issueAMod )
+{
+ const Index h = KnpItm[ j ][ t ];
+ const Index k = p2k( h );
+ KnpScl[ j ][ t ] = s;
+
+ auto BKb = static_cast< BinaryKnapsackBlock * >( v_Block[ j ] );
+ BKb->chg_weight( s , t , issueAMod );
+ if( C[ k ][ j ] < Inf< CNumber >() )
+  BKb->chg_profit( C[ k ][ j ] * s , t , issueAMod );
+
+ if( ( ! ( AR & HasMutual ) ) || ( Startn[ j ] == Endn[ j ] ) )
+  return;
+
+ // the coefficients in the flow constraints of the two endpoints
+ auto var = BKb->get_Var( t );
+ auto lf = static_cast< LinearFunction * >(
+		       FCs[ h ][ Startn[ j ] - StrtNme ].get_function() );
+ lf->modify_coefficient( lf->is_active( var ) , s , issueAMod );
+ lf = static_cast< LinearFunction * >(
+			 FCs[ h ][ Endn[ j ] - StrtNme ].get_function() );
+ lf->modify_coefficient( lf->is_active( var ) , - s , issueAMod );
+ }
+
+/*--------------------------------------------------------------------------*/
+
+void MMCFBlock::chk_knapsack_commodity( Index h , const Vec_CNumber & c ,
+					const Vec_FNumber & u , FNumber mf ,
+					const std::string & who ) const
+{
+ for( Index j = 0 ; j < NArcs ; ++j ) {
+  if( c[ j ] >= Inf< CNumber >() )
+   continue;
+  const FNumber sk = std::min( { u[ j ] , UTot[ j ] , mf } );
+  if( knp_item( h , j ) == Inf< Index >() ) {
+   if( sk > 0 )
+    throw( std::logic_error( who + ": can not open arc " +
+			     std::to_string( j ) +
+			     " in the knapsack formulation" ) );
+   }
+  else
+   if( sk >= Inf< FNumber >() )
+    throw( std::logic_error( who + ": unbounded flow on arc " +
+			     std::to_string( j ) ) );
+  }
+ }
+
+/*--------------------------------------------------------------------------*/
+
+void MMCFBlock::knp_set_max_flow( Index h , FNumber mf , ModParam issueAMod )
+{
+ if( mf == KnpMxF[ h ] )
+  return;
+
+ KnpMxF[ h ] = mf;
+ for( Index j = 0 ; j < NArcs ; ++j ) {
+  const auto t = knp_item( h , j );
+  if( t == Inf< Index >() )
+   continue;
+  const FNumber sk = knp_scale( h , j );
+  if( sk != KnpScl[ j ][ t ] )
+   knp_rescale( j , t , sk , issueAMod );
+  }
+ }
+
+/*--------------------------------------------------------------------------*/
+
+void MMCFBlock::knp_gather_costs( void )
+{
+ // the items of each arc are ordered by commodity position, hence a
+ // cursor per arc finds them all while scanning the commodities in order
+ KnpCst.resize( NArcs );
+ Subset pos( NArcs , 0 );
+ for( Index j = 0 ; j < NArcs ; ++j )
+  KnpCst[ j ].resize( KnpItm[ j ].size() );
+
+ for( Index h = 0 ; h < get_NFrmlK() ; ++h ) {
+  const Index k = p2k( h );
+  ooc_touch( k );
+  const CNumber * const ck = C[ k ].data();
+  for( Index j = 0 ; j < NArcs ; ++j ) {
+   auto & p = pos[ j ];
+   if( ( p < KnpItm[ j ].size() ) && ( KnpItm[ j ][ p ] == h ) )
+    KnpCst[ j ][ p++ ] = ck[ j ];
+   }
+  }
+ }
+
+/*--------------------------------------------------------------------------*/
+
+void MMCFBlock::hyb_rescale( Index i , Index h , ModParam issueAMod )
+{
+ auto BKb = hyb_block( i );
+ const Index r = HybPos[ i ];
+ const Index strt = h < get_NFrmlK() ? h : 0;
+ const Index stop = h < get_NFrmlK() ? h + 1 : get_NFrmlK();
+
+ for( Index p = strt ; p < stop ; ++p ) {
+  const FNumber sk = hyb_scale( p2k( p ) , i );
+  if( sk >= Inf< FNumber >() )
+   throw( std::logic_error( "MMCFBlock: hybrid arc " + std::to_string( i ) +
+			    " has no finite mutual capacity" ) );
+  BKb->chg_weight( sk , p , issueAMod );
+
+  if( AR & HasMutual ) {
+   auto lf = static_cast< LinearFunction * >( HCs[ p ][ r ].get_function() );
+   lf->modify_coefficient( lf->is_active( BKb->get_Var( p ) ) , - sk ,
+			   issueAMod );
+   }
+  }
+ }
+
+/*--------------------------------------------------------------------------*/
+
+void MMCFBlock::chk_mutual_capacity( Index i , const std::string & who ) const
+{
+ if( ! ( AR & HasVar ) )
+  return;
+
+ if( AR & KnapsackRelaxation ) {
+  // every commodity that can now use the arc must have a bounded item
+  for( Index h = 0 ; h < get_NFrmlK() ; ++h ) {
+   if( C[ p2k( h ) ][ i ] >= Inf< CNumber >() )
+    continue;
+   const FNumber sk = knp_scale( h , i );
+   if( knp_item( h , i ) == Inf< Index >() ) {
+    if( sk > 0 )
+     throw( std::logic_error( who + ": can not open arc " +
+			      std::to_string( i ) +
+			      " in the knapsack formulation" ) );
+    }
+   else
+    if( sk >= Inf< FNumber >() )
+     throw( std::logic_error( who + ": unbounded flow on arc " +
+			      std::to_string( i ) ) );
+   }
+  return;
+  }
+
+ if( in_hybrid( i ) ) {
+  if( UTot[ i ] >= Inf< FNumber >() )
+   throw( std::logic_error( who + ": hybrid arc " + std::to_string( i ) +
+			    " has no finite mutual capacity" ) );
+  return;
+  }
+
+ if( ( ! ( AR & HasMutual ) ) || ( mc_row( i ) < MCs.size() ) )
+  return;
+
+ // there is no row: it must still be redundant
+ FNumber Ui = 0;
+ for( Index h = 0 ; h < get_NFrmlK() ; ++h )
+  Ui += U[ p2k( h ) ][ i ];
+ if( Ui > UTot[ i ] )
+  throw( std::logic_error( who + ": constraint of arc " +
+			   std::to_string( i ) + " not in the formulation" ) );
+ }
+
+/*--------------------------------------------------------------------------*/
+
+void MMCFBlock::upd_mutual_capacity( Index i , ModParam issueAMod )
+{
+ const FNumber v = UTot[ i ];
+ const bool knp = AR & KnapsackRelaxation;
+ if( knp || in_hybrid( i ) ) {  // the mutual capacity is in a knapsack
+  auto BKb = knp ? static_cast< BinaryKnapsackBlock * >( v_Block[ i ] )
+                 : hyb_block( i );
+  if( has_design() )
+   BKb->chg_weight( - v , knp ? KnpItm[ i ].size() : get_NFrmlK() ,
+		    issueAMod );
+  else
+   BKb->chg_capacity( v , issueAMod );
+
+  if( ! knp ) {
+   hyb_rescale( i , Inf< Index >() , issueAMod );
+   return;
+   }
+
+  for( Index t = 0 ; t < KnpItm[ i ].size() ; ++t ) {
+   const FNumber sk = knp_scale( KnpItm[ i ][ t ] , i );
+   if( sk != KnpScl[ i ][ t ] )
+    knp_rescale( i , t , sk , issueAMod );
+   }
+  return;
+  }
+
+ if( ! ( AR & HasMutual ) )  // the constraints will be constructed out
+  return;                   // of the new data
+
+ const auto r = mc_row( i );
+ if( r < MCs.size() )
+  MCs[ r ].set_rhs( v , issueAMod );
+ }
+
+/*--------------------------------------------------------------------------*/
+
+void MMCFBlock::chk_commodity_capacity( Index k , Index i ,
+					const std::string & who ) const
+{
+ if( ( ! ( AR & HasVar ) ) || is_trivial( k ) )
+  return;
+
+ const Index h = k2p( k );
+
+ if( AR & PathFormulation ) {
+  const auto beg = PathICArc.begin() + PathICBeg[ h ];
+  const auto end = PathICArc.begin() + PathICBeg[ h + 1 ];
+  if( std::binary_search( beg , end , i ) )
+   return;
+  if( ( C[ k ][ i ] < Inf< CNumber >() ) && ( U[ k ][ i ] < PathDmd[ h ] ) )
+   throw( std::logic_error( who + ": individual capacity constraint of "
+			    "arc " + std::to_string( i ) +
+			    " not in the formulation" ) );
+  return;
+  }
+
+ if( ! ( AR & KnapsackRelaxation ) )
+  return;
+
+ const auto t = knp_item( h , i );
+ if( t == Inf< Index >() ) {  // commodity k can not use arc i
+  if( ( C[ k ][ i ] < Inf< CNumber >() ) &&
+      ( std::min( U[ k ][ i ] , UTot[ i ] ) > 0 ) )
+   throw( std::logic_error( who + ": can not open arc " +
+			    std::to_string( i ) +
+			    " in the knapsack formulation" ) );
+  return;
+  }
+
+ if( knp_scale( h , i ) >= Inf< FNumber >() )
+  throw( std::logic_error( who + ": unbounded flow on arc " +
+			   std::to_string( i ) ) );
+ }
+
+/*--------------------------------------------------------------------------*/
+
+void MMCFBlock::upd_commodity_capacity( Index k , Range rng ,
+					ModParam issueMod ,
+					ModParam issueAMod )
+{
+ if( ( ! ( AR & HasVar ) ) || is_trivial( k ) )
+  return;
+
+ const Index h = k2p( k );
+
+ if( AR & PathFormulation ) {
+  if( ! ( AR & HasMutual ) )
+   return;
+  const auto beg = PathICArc.begin() + PathICBeg[ h ];
+  const auto end = PathICArc.begin() + PathICBeg[ h + 1 ];
+  for( Index i = rng.first ; i < rng.second ; ++i ) {
+   auto it = std::lower_bound( beg , end , i );
+   if( ( it != end ) && ( *it == i ) )
+    PathICs[ std::distance( PathICArc.begin() , it ) ].set_rhs(
+						    U[ k ][ i ] , issueAMod );
+   }
+  return;
+  }
+
+ if( ! ( AR & KnapsackRelaxation ) ) {
+  if( v_Block[ h ] )  // else, it will be constructed with the new data
+   static_cast< MCFBlock * >( v_Block[ h ] )->chg_ucaps(
+				       U[ k ].cbegin() + rng.first , rng ,
+				       issueMod , issueAMod );
+  for( auto i : HybArcs )
+   if( ( i >= rng.first ) && ( i < rng.second ) )
+    hyb_rescale( i , h , issueAMod );
+  return;
+  }
+
+ for( Index j = rng.first ; j < rng.second ; ++j ) {
+  const auto t = knp_item( h , j );
+  if( t == Inf< Index >() )  // commodity k can not use arc j
+   continue;
+  const FNumber sk = knp_scale( h , j );
+  if( sk != KnpScl[ j ][ t ] )
+   knp_rescale( j , t , sk , issueAMod );
+  }
+ }
+
+/*--------------------------------------------------------------------------*/
+
+void MMCFBlock::path_ungroup( Index h )
+{
+ for( auto git = PathGrps.begin() ; git != PathGrps.end() ; ++git ) {
+  auto it = std::find( git->begin() , git->end() , h );
+  if( it == git->end() )
+   continue;
+  if( git->size() > 1 ) {
+   git->erase( it );
+   PathGrps.push_back( Subset( 1 , h ) );
+   }
+  break;
+  }
+ }
+
+/*--------------------------------------------------------------------------*/
+
+void MMCFBlock::chg_path_costs( Index h , Range rng ,
+				const Vec_CNumber & OCost ,
+				ModParam issueAMod )
+{
+ // a commodity whose costs change can no longer share the shortest path
+ // tree with the others having the same costs
+ path_ungroup( h );
+
+ auto lf = static_cast< LinearFunction * >( PathObj.get_function() );
+ const auto & Ck = C[ p2k( h ) ];
+ auto pit = PathArcs[ h ].begin();
+ for( auto & var : PathVars[ h ] ) {
+  const auto & P = *(pit++);
+  bool touched = false;
+  bool wasclsd = false;  // true if the path used an arc closed by C
+  for( auto i : P )  // only the arcs whose cost has actually changed
+   if( ( i >= rng.first ) && ( i < rng.second ) &&
+       ( OCost[ i - rng.first ] != Ck[ i ] ) ) {
+    touched = true;
+    if( OCost[ i - rng.first ] == Inf< CNumber >() )
+     wasclsd = true;
+    }
+  if( ! touched )
+   continue;
+
+  CNumber cost = 0;
+  for( auto i : P )
+   cost += Ck[ i ];
+
+  if( cost == Inf< CNumber >() ) {  // the path uses a closed arc
+   var.set_value( 0 );
+   var.fix( issueAMod );
+   continue;
+   }
+
+  if( wasclsd )  // all its arcs are open again
+   var.unfix( issueAMod );
+  if( lf )
+   lf->modify_coefficient( lf->is_active( & var ) , cost , issueAMod );
+  }
+ }  // end( MMCFBlock::chg_path_costs )
+
+/*--------------------------------------------------------------------------*/
+/*-------------------------- PROTECTED METHODS -----------------------------*/
+/*--------------------------------------------------------------------------*/
+ 
 void MMCFBlock::PreProcess( FNumber IncUk , FNumber DecUk ,
 			    FNumber IncUjk , FNumber DecUjk ,
 			    FNumber ChgDfct , CNumber DecCsts )
@@ -1329,118 +4560,104 @@ void MMCFBlock::PreProcess( FNumber IncUk , FNumber DecUk ,
  if( DecCsts > Inf< double >() )
   throw( std::invalid_argument( "infinite DecCsts" ) );
 
- // allocate (temporary) data structures- - - - - - - - - - - - - - - - - - -
- // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ // if PreProcess() has already been called, restore the original values- -
+ // of the capacities it has squeezed, so as to start from the real data - -
 
- Active.resize( NArcs );
+ if( PPDone ) {
+  UTot = UTotOrg;
+  for( Index k = 0 ; k < NComm ; k++ )
+   if( ! USqzd[ k ].empty() ) {
+    ooc_touch( k );
+    for( auto & sq : USqzd[ k ] )
+     U[ k ].mut()[ sq.first ] = sq.second;
+    }
+  }
+
+ PPIncUk = IncUk;
+ PPDecUk = DecUk;
+ PPIncUjk = IncUjk;
+ PPDecUjk = DecUjk;
+ PPChgDfct = ChgDfct;
+ PPDecCsts = DecCsts;
+ PPDone = true;
+
+ UTotOrg = UTot;
+ USqzd.clear();
+ USqzd.resize( NComm );
 
- Vec_FNumber tmpv( NComm );
- Subset srck( NComm );
+ // allocate data structures- - - - - - - - - - - - - - - - - - - - - - - - -
+ // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+ Active.mut().resize( NArcs );
 
  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
  // squeeze rhss, declare arcs as "non-existent", etc.- - - - - - - - - - - -
  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
- // ensure that all arcs entering/leaving a non-existent node do not exist- -
+ // ensure that all arcs entering/leaving a non-existent node do not exist,
+ // and that all non-existent arcs have zero capacity - - - - - - - - - - - -
  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ // note: all the passes over the commodities only look at the data of one
+ // commodity at a time, so that they stream in out-of-core mode
 
- for( Index k = 0 ; k < NComm ; k++ )
-  for( Index i = 0 ; i < NArcs ; i++ )
+ for( Index k = 0 ; k < NComm ; k++ ) {
+  ooc_touch( k );
+  for( Index i = 0 ; i < NArcs ; i++ ) {
    if( ( B[ k ][ Startn[ i ] - StrtNme ] == Inf< double >() ) ||
        ( B[ k ][ Endn[ i ] - StrtNme ] == Inf< double >() ) )
-    C[ k ][ i ] = Inf< double >();
-
- // ensure that all non-existent arcs have zero capacity- - - - - - - - - - -
- // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    C[ k ].mut()[ i ] = Inf< double >();
 
- for( Index k = 0 ; k < NComm ; k++ )
-  for( Index i = 0 ; i < NArcs ; i++ )
    if( C[ k ][ i ] == Inf< double >() )
-    U[ k ][ i ] = 0;
+    U[ k ].mut()[ i ] = 0;
+   }
+  }
 
  // a *very* rough estimate of the max. flow across any arc is computed for
- // each commodity, and it is stored in tmpv[ k ] - - - - - - - - - - - - - -
+ // each commodity, and it is stored in MaxFlwK[ k ] - - - - - - - - - - - - -
  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
- FNumber maxU = 0;
+ MaxFlwK.resize( NComm );
+ MaxFlw = 0;
  for( Index k = NComm ; k-- ; ) {
-  // first, count the flow out of the sources
-
-  Index srcs = 0;    // meanwhile, the sources are counted
-  FNumber maxUk = 0;
-  for( auto &Bk : B[k] )
-   if( Bk < 0 ) {
-    srcs++;
-    maxUk -= Bk;
-    }
+  ooc_touch( k );
+  MaxFlw += ( MaxFlwK[ k ] = pp_max_flow( k ) );
+  }
 
-  // now the contribution of arcs with potentially negative costs
-  for( Index j = 0 ; j < NArcs ; j++ ) {
-   const FNumber tMF = std::min( U[ k ][ j ] , UTot[ j ] );
+ // if mutual capacities can not increase, the arcs with zero mutual- - - - -
+ // capacity do not exist; meanwhile, if needed compute an upper bound on - -
+ // the quantity of flow on each arc [see pp_mutual()]- - - - - - - - - - - -
+ // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-   if( C[ k ][ j ] < DecCsts ) {
-    if( tMF >= Inf< double >() )
-     throw( std::invalid_argument( "negative cost, infinite capacity" ) );
-    maxUk += tMF;
-    }
+ Vec_FNumber UMx;
+ if( ( PPDecUk < Inf< double >() ) && ( PPIncUjk < Inf< double >() ) )
+  UMx.assign( NArcs , 0 );
+
+ if( ( ! UMx.empty() ) || ( ! PPIncUk ) )
+  for( Index k = NComm ; k-- ; ) {
+   ooc_touch( k );
+   for( Index i = 0 ; i < NArcs ; i++ )
+    if( ( ! PPIncUk ) && ( ! UTot[ i ] ) ) {
+     C[ k ].mut()[ i ] = Inf< double >();
+     U[ k ].mut()[ i ] = 0;
+     }
+    else
+     if( ! UMx.empty() )
+      UMx[ i ] += pp_flow_bound( k , i );
    }
 
-  srck[ k ] = srcs;
-  maxUk += ( ( NNodes + 1 ) / 2 ) * ChgDfct;  // count potential changes in
-  maxU += ( tmpv[ k ] = maxUk );              // the deficits
-  }
-
  // detection of redundant mutual capacity constraints is attempted, and- - -
  // all the mutual capacity upper bounds are turned to finite values- - - - -
  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
- for( Index i = NCnst = 0 ; i < NArcs ; i++ ) {
-  if( ( ! IncUk ) && ( ! UTot[ i ] ) ) {   // if mutual capacities can not
-   for( Index k = NComm ; k-- ; ) {        // increase, and UTot[] == 0 ...
-    C[ k ][ i ] = Inf< double >();         // ... this arc does not exist
-    U[ k ][ i ] = 0;
-    }
-
-   continue;
-   }
-
-  if( DecUk == Inf< double >() ) {     // all mutual capacity constraints exist
-   if( UTot[ i ] == Inf< double >() )  // but those that are declared non-so
-    UTot[ i ] = maxU;                  // ensure that UTot is "finite" anyway
-   else
-    Active[ NCnst++ ] = i;
-
-   continue;
-   }
-
-  // compute is an upper bound on the max quantity of flow (of any commodity)
-  // on arc i: if capacities can increase indefinitely, the only bound is
-  // the total quantity of flow in the graph
-
-  FNumber Ui = 0;
-  if( IncUjk < Inf< double >() )
-   for( Index k = NComm ; k-- ; )
-    if( U[ k ][ i ] == Inf< double >() )
-     Ui += tmpv[ k ];
-    else
-     Ui += std::min( tmpv[ k ] , U[ k ][ i ] + IncUjk );
-  else
-   Ui = maxU;
-
-  // note: when e.g. the mutual capacity and the sum of all the individual
-  // capacities of an arc are identical, the arc is marked as "inactive"; this
-  // is an arbitrary choice, since one could as well keep it and eliminate all
-  // the individual capacities
-
-  if( UTot[ i ] >= Ui - DecUk )
-   UTot[ i ] = Ui;
-  else
-   Active[ NCnst++ ] = i;
-
-  }  // end for( i )
+ for( Index i = NCnst = 0 ; i < NArcs ; i++ )
+  if( ( PPIncUk || UTot[ i ] ) &&   // else, already closed above
+      pp_mutual( i , nullptr , UMx.empty() ? nullptr : & UMx ) )
+   Active.mut()[ NCnst++ ] = i;
 
  if( NCnst < NArcs )
-  Active[ NCnst ] = Inf< Index >();
+  Active.mut()[ NCnst ] = Inf< Index >();
+
+ NamesK[ 0 ] = NCnst;
 
  // now a squeeze of single-commodity capacities is attempted, and SPTs are -
  // definitively recognized - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -1448,146 +4665,577 @@ void MMCFBlock::PreProcess( FNumber IncUk , FNumber DecUk ,
  // meanwhile, construct the "active" individual capacity constraints
 
  for( Index k = 0 ; k < NComm ; k++ ) {
+  ooc_touch( k );
   ActiveK[ k ].clear();
-  ActiveK[ k ].resize( NArcs );
+  ActiveK[ k ].mut().resize( NArcs );
 
   Index cnt = 0;  // active individual capacity constraints
   Index count1 = 0;
-  Index count2 = 0;
   for( Index i = 0 ; i < NArcs ; i++ ) {
    bool Ai = ( Active[count1] == i );    // true if arc i is "active"
    if( Ai )
     count1++;
 
-   if( C[ k ][ i ] == Inf< double >() )  // a non-existent arc
-    continue;
+   if( pp_individual( k , i , Ai ) == kPPActive )
+    ActiveK[ k ].mut()[ cnt++ ] = i;
+   }
+
+  ///if( ( ! cnt ) && ( srck[ k ] == 1 ) )
+  /// PT[ k ] = kSPT;
+
+  NamesK[ k + 1 ] = NamesK[ k ] + cnt;
+
+  if( cnt >= NArcs )   // all individual capacity constraints are active
+   ActiveK[ k ].clear();
+  else { // some are active, some are not
+   ActiveK[ k ].mut().resize(cnt + 1);
+   ActiveK[ k ].mut()[ cnt ] = Inf< Index >();
+   }
+  }   // end for( k )
+
+ if( NCnst >= NArcs )
+  Active.clear();
+
+ // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ // find and eliminate redundancies in the data structures- - - - - - - - - -
+ // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+ // this compares the data of all pairs of commodities, hence it is not
+ // done in out-of-core mode [see set_out_of_core()]
 
-   if( ( ! IncUjk ) && ( ! U[ k ][ i ] ) ) {
-    // an arc that can be declared non-existent by its capacity
-    // (that will never increase)
-    C[ k ][ i ] = Inf< double >();
+ BIsCpy.clear();
+ UIsCpy.clear();
+ CIsCpy.clear();
+
+ if( ! OOCMap ) {
+
+  // examine B[] - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  BIsCpy.resize( NComm , bool( false ) );
+
+  bool cpy = false;
+  for( Index k = 1 ; k < NComm ; k++ )
+   for( Index i = 0 ; i < k ; i++ )
+    if( ( ! BIsCpy[ i ] ) && ( B[ k ] == B[ i ] ) ) {
+     BIsCpy[ k ] = cpy = true;
+     B[ k ] = B[ i ];  // share the data
+     break;
+     }
+
+  if( ! cpy )
+   BIsCpy.clear();
+
+  // examine U[] and UTot- - - - - - - - - - - - - - - - - - - - - - - - - - -
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  UIsCpy.resize( NComm , bool( false ) );
+
+  cpy = false;
+  if( U[ 0 ] == UTot ) {
+   UIsCpy[ 0 ] = cpy = true;
+   U[ 0 ] = UTot;  // share the data
+   }
+
+  for( Index k = 1 ; k < NComm ; k++ )
+   for( Index i = 0 ; i < k ; i++ )
+    if( ( ! UIsCpy[ i ] ) && ( U[ k ] == U[ i ] ) ) {
+     UIsCpy[ k ] = cpy = true;
+     U[ k ] = U[ i ];  // share the data
+     break;
+     }
+
+  if( ! cpy )
+   UIsCpy.clear();
+
+  // examine C[] - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  CIsCpy.resize( NComm , bool( false ) );
+
+  cpy = false;
+  for( Index k = 1 ; k < NComm ; k++ )
+   for( Index i = 0 ; i < k ; i++ )
+    if( ( ! CIsCpy[ i ] ) && ( C[ k ] == C[ i ] ) ) {
+     CIsCpy[ k ] = cpy = true;
+     C[ k ] = C[ i ];  // share the data
+     break;
+     }
+
+  if( ! cpy )
+   CIsCpy.clear();
+
+  }  // end( if( ! OOCMap ) )
+
+ // re-examine trivial commodities, since arcs may have been removed - - - -
+ // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+ find_trivial_commodities();
+
+ }  // end( MMCFBlock::PreProcess )
+
+/*--------------------------------------------------------------------------*/
+
+void MMCFBlock::PreProcess( c_Subset & arcs , c_Subset & comms ,
+			    PPChanges * chgs )
+{
+ if( ! PPDone )
+  throw( std::logic_error(
+	       "MMCFBlock::PreProcess: the full version was never called" ) );
+
+ if( chgs ) {
+  chgs->MutualOn.clear();
+  chgs->MutualOff.clear();
+  chgs->Comms.clear();
+  chgs->Closed.clear();
+  }
+
+ // with the formulation constructed, the changes have to be put in it: the
+ // data is saved, to be restored if the formulation can not represent them
+ // (in out-of-core mode, the saved rows must not refer to the file)
+
+ const bool frml = AR & HasVar;
+ std::vector< std::pair< Index , Index > > lcls;
+ auto cls = chgs ? & chgs->Closed : ( frml ? & lcls : nullptr );
+
+ SharedVector< FNumber > oUTot;
+ std::vector< SharedVector< FNumber > > oU;
+ std::vector< SharedVector< CNumber > > oC;
+ decltype( USqzd ) oUSqzd;
+ SharedVector< Index > oActive;
+ std::vector< SharedVector< Index > > oActiveK;
+ Vec_FNumber oMaxFlwK;
+ const FNumber oMaxFlw = MaxFlw;
+ const Index oNCnst = NCnst;
+ if( frml ) {
+  oUTot = UTot;
+  oU = U;
+  oC = C;
+  if( OOCMap )
+   for( Index k = 0 ; k < NComm ; ++k ) {
+    oU[ k ].unmap();
+    oC[ k ].unmap();
+    }
+  oUSqzd = USqzd;
+  oActive = Active;
+  oActiveK = ActiveK;
+  oMaxFlwK = MaxFlwK;
+  }
+
+ // the commodities to be entirely re-examined are those that have changed -
+ // and those whose max. flow estimate may have changed, i.e., those having -
+ // a (potentially) negative-cost changed arc - - - - - - - - - - - - - - - -
+
+ Vec_Bool rdoK( NComm , false );
+ for( auto k : comms )
+  rdoK[ k ] = true;
+
+ for( Index k = 0 ; k < NComm ; k++ )
+  if( ( ! rdoK[ k ] ) && ( ! arcs.empty() ) ) {
+   ooc_touch( k );
+   for( auto i : arcs )
+    if( C[ k ][ i ] < PPDecCsts ) {
+     rdoK[ k ] = true;
+     break;
+     }
+   }
+
+ bool chgMF = false;  // true if any max. flow estimate has changed
+ for( Index k = 0 ; k < NComm ; k++ )
+  if( rdoK[ k ] ) {
+   ooc_touch( k );
+   for( auto & sq : USqzd[ k ] )  // the max. flow estimate is computed
+    U[ k ].mut()[ sq.first ] = sq.second;  // out of the original capacities
+   USqzd[ k ].clear();
+
+   const FNumber MFk = pp_max_flow( k );
+   if( MFk != MaxFlwK[ k ] ) {
+    MaxFlw += MFk - MaxFlwK[ k ];
+    MaxFlwK[ k ] = MFk;
+    chgMF = true;
+    }
+   }
+
+ // re-examine mutual capacity constraints: if any max. flow estimate has -
+ // changed then the bound on the flow of all arcs has, and all of them have
+ // to be re-examined, otherwise only the changed ones- - - - - - - - - - - -
+
+ Vec_Bool rdoA( NArcs , chgMF );
+ for( auto i : arcs )
+  rdoA[ i ] = true;
+
+ Vec_Bool actA( NArcs , Active.empty() );
+ if( ! Active.empty() )
+  for( Index j = 0 ; j < NCnst ; j++ )
+   actA[ Active[ j ] ] = true;
+
+ for( Index i = 0 ; i < NArcs ; i++ ) {
+  if( ! rdoA[ i ] )
+   continue;
+
+  UTot.mut()[ i ] = UTotOrg[ i ];
+  const bool Ai = pp_mutual( i , cls );
+  if( Ai != actA[ i ] ) {
+   actA[ i ] = Ai;
+   if( chgs )
+    ( Ai ? chgs->MutualOn : chgs->MutualOff ).push_back( i );
+   }
+  }
+
+ Active.mut().resize( NArcs );
+ NCnst = 0;
+ for( Index i = 0 ; i < NArcs ; i++ )
+  if( actA[ i ] )
+   Active.mut()[ NCnst++ ] = i;
+
+ if( NCnst < NArcs )
+  Active.mut()[ NCnst ] = Inf< Index >();
+ else
+  Active.clear();
+
+ // re-examine individual capacity constraints- - - - - - - - - - - - - - - -
+ // those of the re-examined commodities for all arcs, those of all the - - -
+ // commodities for the re-examined arcs- - - - - - - - - - - - - - - - - - -
+
+ const bool anyA = chgMF || ( ! arcs.empty() );
+ Vec_Bool actK( NArcs );
+
+ for( Index k = 0 ; k < NComm ; k++ ) {
+  if( ( ! rdoK[ k ] ) && ( ! anyA ) )
+   continue;
+
+  ooc_touch( k );
+
+  if( ActiveK[ k ].empty() )
+   actK.assign( NArcs , true );
+  else {
+   actK.assign( NArcs , false );
+   for( auto i : ActiveK[ k ] )
+    if( i < NArcs )
+     actK[ i ] = true;
+   }
+
+  bool chg = false;
+  for( Index i = 0 ; i < NArcs ; i++ ) {
+   if( ( ! rdoK[ k ] ) && ( ! rdoA[ i ] ) )
     continue;
+
+   // restore the original individual capacity, if it had been squeezed
+   auto it = std::lower_bound( USqzd[ k ].begin() , USqzd[ k ].end() ,
+			       std::make_pair( i , FNumber( 0 ) ) ,
+			       []( const auto & a , const auto & b ) {
+				return( a.first < b.first ); } );
+   if( ( it != USqzd[ k ].end() ) && ( it->first == i ) ) {
+    U[ k ].mut()[ i ] = it->second;
+    USqzd[ k ].erase( it );
+    }
+
+   const bool Aki = ( pp_individual( k , i , actA[ i ] , cls ) == kPPActive );
+   if( Aki != actK[ i ] ) {
+    actK[ i ] = Aki;
+    chg = true;
     }
+   }
+
+  if( ! chg )
+   continue;
 
-   if( DecUjk < Inf< double >() ) {
-    // if individual capacities cannot decrease forever, then the
-    // individual capacity constraint of some existing arc can be
-    // declared redundant
+  if( chgs )
+   chgs->Comms.push_back( k );
 
-    if( U[ k ][ i ] >= tmpv[ k ] + DecUjk ) {
-     // the constraint is redundant because there will never be that much
-     // flow in the graph: anyway, give it a "nice" finite value
-     U[ k ][ i ] = std::min( tmpv[ k ] , UTot[ i ] );
-     continue;
+  const Index cnt = std::count( actK.begin() , actK.end() , true );
+  ActiveK[ k ].clear();
+  if( cnt < NArcs ) {
+   ActiveK[ k ].mut().reserve( cnt + 1 );
+   for( Index i = 0 ; i < NArcs ; i++ )
+    if( actK[ i ] )
+     ActiveK[ k ].mut().push_back( i );
+   ActiveK[ k ].mut().push_back( Inf< Index >() );
+   }
+  }  // end( for( k ) )
+
+ // recompute the names of the dual multipliers - - - - - - - - - - - - - - -
+
+ set_NamesK();
+
+ // if the abstract representation is there, check that it can represent
+ // the changed capacities, restoring everything as it was otherwise - - - -
+
+ Subset chgA;                                   // arcs with changed UTot
+ std::vector< std::pair< Index , Range > > chgK;  // changed rows of U
+ if( frml ) {
+  for( Index i = 0 ; i < NArcs ; ++i )
+   if( UTot[ i ] != oUTot[ i ] )
+    chgA.push_back( i );
+
+  for( Index k = 0 ; k < NComm ; ++k ) {
+   ooc_touch( k );
+   if( U[ k ] == oU[ k ] )
+    continue;
+   Range rng( NArcs , 0 );
+   for( Index i = 0 ; i < NArcs ; ++i )
+    if( U[ k ][ i ] != oU[ k ][ i ] ) {
+     rng.first = std::min( rng.first , i );
+     rng.second = i + 1;
      }
+   if( rng.first < rng.second )
+    chgK.push_back( std::make_pair( k , rng ) );
+   }
 
-    if( ( IncUk < Inf< double >() ) &&
-	( Ai && ( U[ k ][ i ] >= UTot[ i ] + IncUk + DecUjk ) ) ) {
-     // if mutual capacities cannot increase forever, some individual
-     // capacities may be declared redundant by the mutual capacity
-     // note that the mutual capacity of an arc can be used to declare
-     // that the individual capacity is redundant only if the arc is
-     // "active", as "inactive" arcs precisely mean that no mutual
-     // capacity constraint is imposed on them (i.e., the value of
-     // UTot[ i ] is not really meaningful and can be ignored)
-
-     U[ k ][ i ] = UTot[ i ];  // give it a "nice" finite value anyway
-     continue;
+  try {
+   for( auto i : chgA )
+    chk_mutual_capacity( i , "MMCFBlock::PreProcess" );
+   for( auto & kr : chgK ) {
+    ooc_touch( kr.first );
+    for( Index i = kr.second.first ; i < kr.second.second ; ++i )
+     chk_commodity_capacity( kr.first , i , "MMCFBlock::PreProcess" );
+    }
+   }
+  catch( ... ) {
+   UTot = std::move( oUTot );
+   U = std::move( oU );
+   C = std::move( oC );
+   USqzd = std::move( oUSqzd );
+   Active = std::move( oActive );
+   ActiveK = std::move( oActiveK );
+   MaxFlwK = std::move( oMaxFlwK );
+   MaxFlw = oMaxFlw;
+   NCnst = oNCnst;
+   set_NamesK();
+   if( chgs ) {
+    chgs->MutualOn.clear();
+    chgs->MutualOff.clear();
+    chgs->Comms.clear();
+    chgs->Closed.clear();
+    }
+   throw;
+   }
+  }
+
+ // if the abstract representation is there, make the arcs that have been -
+ // declared un-existent disappear from it- - - - - - - - - - - - - - - - - -
+
+ if( cls && frml )
+  for( auto & ki : *cls ) {
+   if( is_trivial( ki.first ) )
+    continue;
+   if( AR & PathFormulation ) {  // fix to 0 all the paths using the arc
+    const auto h = k2p( ki.first );
+    auto pit = PathArcs[ h ].begin();
+    for( auto & var : PathVars[ h ] ) {
+     if( std::find( pit->begin() , pit->end() , ki.second ) != pit->end() ) {
+      var.set_value( 0 );
+      var.fix();
+      }
+     ++pit;
+     }
+    }
+   else
+   if( ! ( AR & KnapsackRelaxation ) ) {
+    if( auto MCFb = v_Block[ k2p( ki.first ) ] )  // else C is enough
+     static_cast< MCFBlock * >( MCFb )->close_arc( ki.second );
+    if( in_hybrid( ki.second ) ) {  // the copy in the knapsack, too
+     auto var = hyb_block( ki.second )->get_Var( k2p( ki.first ) );
+     var->set_value( 0 );
+     var->fix();
+     }
+    }
+   else {
+    const auto t = knp_item( k2p( ki.first ) , ki.second );
+    if( t < Inf< Index >() ) {  // a non-existent item is closed already
+     auto var = static_cast< BinaryKnapsackBlock * >(
+					   v_Block[ ki.second ] )->get_Var( t );
+     var->set_value( 0 );
+     var->fix();
      }
     }
+   }
 
-   ActiveK[ k ][ count2++ ] = i;
-   cnt++;
+ // and put the changed capacities in it- - - - - - - - - - - - - - - - - -
 
-   }  // end for( i )
+ for( auto i : chgA )
+  upd_mutual_capacity( i , eModBlck );
+ for( auto & kr : chgK ) {
+  ooc_touch( kr.first );
+  upd_commodity_capacity( kr.first , kr.second , eModBlck , eModBlck );
+  }
 
-  ///if( ( ! cnt ) && ( srck[ k ] == 1 ) )
-  /// PT[ k ] = kSPT;
+ // re-examine trivial commodities (this has no effect if the abstract - - -
+ // representation has already been constructed) - - - - - - - - - - - - - -
+
+ find_trivial_commodities();
+
+ }  // end( MMCFBlock::PreProcess( incremental ) )
+
+/*--------------------------------------------------------------------------*/
+
+FNumber MMCFBlock::pp_max_flow( Index k ) const
+{
+ // first, count the flow out of the sources
+
+ FNumber maxUk = 0;
+ for( auto &Bk : B[k] )
+  if( Bk < 0 )
+   maxUk -= Bk;
+
+ // now the contribution of arcs with potentially negative costs, using the
+ // original (non-squeezed) capacities
+ for( Index j = 0 ; j < NArcs ; j++ ) {
+  const FNumber tMF = std::min( U[ k ][ j ] , UTotOrg[ j ] );
+
+  if( C[ k ][ j ] < PPDecCsts ) {
+   if( tMF >= Inf< double >() )
+    throw( std::invalid_argument( "negative cost, infinite capacity" ) );
+   maxUk += tMF;
+   }
+  }
+
+ maxUk += ( ( NNodes + 1 ) / 2 ) * PPChgDfct;  // count potential changes in
+ return( maxUk );                              // the deficits
+ }
+
+/*--------------------------------------------------------------------------*/
+
+FNumber MMCFBlock::pp_flow_bound( Index k , Index i ) const
+{
+ const FNumber Uki = orig_U( k , i );
+ if( Uki == Inf< double >() )
+  return( MaxFlwK[ k ] );
 
-  NamesK[ k + 1 ] = NamesK[ k ] + cnt;
+ return( std::min( MaxFlwK[ k ] , Uki + PPIncUjk ) );
+ }
 
-  if( cnt >= NArcs )   // all individual capacity constraints are active
-   ActiveK[ k ].clear();
-  else { // some are active, some are not
-   ActiveK[ k ].resize(cnt + 1);
-   ActiveK[ k ][ cnt ] = Inf< Index >();
+/*--------------------------------------------------------------------------*/
+
+bool MMCFBlock::pp_mutual( Index i , std::vector< std::pair< Index , Index > >
+			   * cls , const Vec_FNumber * UMx )
+{
+ if( ( ! PPIncUk ) && ( ! UTot[ i ] ) ) {  // if mutual capacities can not
+  for( Index k = NComm ; k-- ; ) {        // increase, and UTot[] == 0 ...
+   if( cls && ( C[ k ][ i ] < Inf< double >() ) )
+    cls->push_back( std::make_pair( k , i ) );
+   C[ k ].mut()[ i ] = Inf< double >();         // ... this arc does not exist
+   U[ k ].mut()[ i ] = 0;
    }
-  }   // end for( k )
 
- if( NCnst >= NArcs )
-  Active.clear();
+  return( false );
+  }
 
- // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
- // find and eliminate redundancies in the data structures- - - - - - - - - -
- // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ if( PPDecUk == Inf< double >() ) {   // all mutual capacity constraints exist
+  if( UTot[ i ] == Inf< double >() ) {  // but those that are declared non-so
+   UTot.mut()[ i ] = MaxFlw;            // ensure that UTot is "finite" anyway
+   return( false );
+   }
 
- // examine B[] - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
- // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+  return( true );
+  }
 
- BIsCpy.resize( NComm , bool( false ) );
+ // compute is an upper bound on the max quantity of flow (of any commodity)
+ // on arc i: if capacities can increase indefinitely, the only bound is
+ // the total quantity of flow in the graph; note that the original
+ // individual capacities are used, since the squeezed ones may depend on
+ // UTot[ i ] itself
 
- bool cpy = false;
- for( Index k = 1 ; k < NComm ; k++ )
-  for( Index i = 0 ; i < k ; i++ )
-   if( ( ! BIsCpy[ i ] ) && ( B[ k ] == B[ i ] ) ) {
-    BIsCpy[ k ] = cpy = true;
-    B[ k ].resize( B[ i ].size() );
-    std::copy( B[ i ].begin() , B[ i ].end(), B[ k ].begin() );
-    break;
-    }
+ FNumber Ui = 0;
+ if( UMx )
+  Ui = (*UMx)[ i ];
+ else
+  if( PPIncUjk < Inf< double >() )
+   for( Index k = NComm ; k-- ; )
+    Ui += pp_flow_bound( k , i );
+  else
+   Ui = MaxFlw;
 
- if( ! cpy )
-  BIsCpy.clear();
+ // note: when e.g. the mutual capacity and the sum of all the individual
+ // capacities of an arc are identical, the arc is marked as "inactive"; this
+ // is an arbitrary choice, since one could as well keep it and eliminate all
+ // the individual capacities
 
- // examine U[] and UTot- - - - - - - - - - - - - - - - - - - - - - - - - - -
- // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ if( UTot[ i ] >= Ui - PPDecUk ) {
+  UTot.mut()[ i ] = Ui;
+  return( false );
+  }
+
+ return( true );
+ }
 
- UIsCpy.resize( NComm , bool( false ) );
+/*--------------------------------------------------------------------------*/
 
- cpy = false;
- if( U[ 0 ] == UTot ) {
-  UIsCpy[ 0 ] = cpy = true;
-  U[ 0 ].resize( UTot.size() );
-  std::copy( UTot.begin() , UTot.end(), U[ 0 ].begin() );
+int MMCFBlock::pp_individual( Index k , Index i , bool Ai ,
+			      std::vector< std::pair< Index , Index > > * cls )
+{
+ if( C[ k ][ i ] == Inf< double >() )  // a non-existent arc
+  return( kPPNonExistent );
+
+ if( ( ! PPIncUjk ) && ( ! U[ k ][ i ] ) ) {
+  // an arc that can be declared non-existent by its capacity
+  // (that will never increase)
+  C[ k ].mut()[ i ] = Inf< double >();
+  if( cls )
+   cls->push_back( std::make_pair( k , i ) );
+  return( kPPNonExistent );
   }
 
- for( Index k = 1 ; k < NComm ; k++ )
-  for( Index i = 0 ; i < k ; i++ )
-   if( ( ! UIsCpy[ i ] ) && ( U[ k ] == U[ i ] ) ) {
-    UIsCpy[ k ] = cpy = true;
-    U[ k ].resize( U[ i ].size() );
-    std::copy( U[ i ].begin() , U[ i ].end(), U[ k ].begin() );
-    break;
-    }
+ if( PPDecUjk < Inf< double >() ) {
+  // if individual capacities cannot decrease forever, then the
+  // individual capacity constraint of some existing arc can be
+  // declared redundant
 
- if( ! cpy )
-  UIsCpy.clear();
+  if( U[ k ][ i ] >= MaxFlwK[ k ] + PPDecUjk ) {
+   // the constraint is redundant because there will never be that much
+   // flow in the graph: anyway, give it a "nice" finite value
+   squeeze_U( k , i , std::min( MaxFlwK[ k ] , UTot[ i ] ) );
+   return( kPPRedundant );
+   }
 
- // examine C[] - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
- // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+  if( ( PPIncUk < Inf< double >() ) &&
+      ( Ai && ( U[ k ][ i ] >= UTot[ i ] + PPIncUk + PPDecUjk ) ) ) {
+   // if mutual capacities cannot increase forever, some individual
+   // capacities may be declared redundant by the mutual capacity
+   // note that the mutual capacity of an arc can be used to declare
+   // that the individual capacity is redundant only if the arc is
+   // "active", as "inactive" arcs precisely mean that no mutual
+   // capacity constraint is imposed on them (i.e., the value of
+   // UTot[ i ] is not really meaningful and can be ignored)
+
+   squeeze_U( k , i , UTot[ i ] );  // give it a "nice" finite value anyway
+   return( kPPRedundant );
+   }
+  }
 
- CIsCpy.resize( NComm , bool( false ) );
+ return( kPPActive );
+ }
 
- cpy = false;
- for( Index k = 1 ; k < NComm ; k++ )
-  for( Index i = 0 ; i < k ; i++ )
-   if( ( ! CIsCpy[ i ] ) && ( C[ k ] == C[ i ] ) ) {
-    CIsCpy[ k ] = cpy = true;
-    C[ k ].resize( C[ i ].size() );
-    std::copy( C[ i ].begin() , C[ i ].end(), C[ k ].begin() );
-    break;
-    }
+/*--------------------------------------------------------------------------*/
 
- if( ! cpy )
-  CIsCpy.clear();
+void MMCFBlock::squeeze_U( Index k , Index i , FNumber Uki )
+{
+ // record the original value, keeping USqzd[ k ] ordered by arc name
+ auto it = std::lower_bound( USqzd[ k ].begin() , USqzd[ k ].end() ,
+			     std::make_pair( i , FNumber( 0 ) ) ,
+			     []( const auto & a , const auto & b ) {
+			      return( a.first < b.first ); } );
+ if( ( it == USqzd[ k ].end() ) || ( it->first != i ) )
+  USqzd[ k ].insert( it , std::make_pair( i , U[ k ][ i ] ) );
+
+ U[ k ].mut()[ i ] = Uki;
+ }
 
- // cleanup - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
- // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+/*--------------------------------------------------------------------------*/
 
- srck.clear();
- tmpv.clear();
+FNumber MMCFBlock::orig_U( Index k , Index i ) const
+{
+ if( k < USqzd.size() ) {
+  auto it = std::lower_bound( USqzd[ k ].begin() , USqzd[ k ].end() ,
+			      std::make_pair( i , FNumber( 0 ) ) ,
+			      []( const auto & a , const auto & b ) {
+			       return( a.first < b.first ); } );
+  if( ( it != USqzd[ k ].end() ) && ( it->first == i ) )
+   return( it->second );
+  }
 
- }  // end( MMCFBlock::PreProcess )
+ return( U[ k ][ i ] );
+ }
 
 /*--------------------------------------------------------------------------*/
 
@@ -1612,25 +5260,71 @@ void MMCFBlock::serialize( netCDF::NcGroup & group ) const
  netCDF::NcDim nc = group.addDim( "NComm" , get_NComm() );
  netCDF::NcDim ncnst = group.addDim( "NCnst" , NCnst);
 
- ( group.addVar( "SN" , netCDF::NcUint64() , na ) ).putVar( Startn.data() );
-
- ( group.addVar( "EN" , netCDF::NcUint64() , na ) ).putVar( Endn.data() );
+ write_arcs( group , na );
 
- ( group.addVar( "Utot" , netCDF::NcDouble() , na ) ).putVar( UTot.data() );
+ if( OOCMap )  // out-of-core: write one commodity at a time
+  write_rows( group , Range( 0 , NComm ) , nc , na , nn );
+ else {
+  ::serialize( group, "U", netCDF::NcDouble(), to_plain( U ), {nc,na});
 
- if( F.size() == NArcs )
-  ( group.addVar( "F" , netCDF::NcDouble() , na ) ).putVar( F.data() );
+  ::serialize( group, "B", netCDF::NcDouble(), to_plain( B ), {nc,nn});
 
- ::serialize( group, "U", netCDF::NcDouble(), U, {nc,na});
-              
- ::serialize( group, "B", netCDF::NcDouble(), B, {nc,nn});
-              
- ::serialize( group, "C", netCDF::NcDouble(), C, {nc,na});
+  ::serialize( group, "C", netCDF::NcDouble(), to_plain( C ), {nc,na});
+  }
 
  }  // end( MCFBlock::serialize )
 
 /*--------------------------------------------------------------------------*/
 
+void MMCFBlock::serialize_topology( netCDF::NcGroup & group ) const
+{
+ group.addDim( "NNodes" , get_NNodes() );
+ netCDF::NcDim na = group.addDim( "NArcs" , get_NArcs() );
+ group.addDim( "NComm" , get_NCommGlobal() );
+
+ write_arcs( group , na );
+ }
+
+/*--------------------------------------------------------------------------*/
+
+void MMCFBlock::serialize_shard( netCDF::NcGroup & group , Range comms )
+ const
+{
+ comms.second = std::min( comms.second , NComm );
+ if( comms.first >= comms.second )
+  throw( std::invalid_argument( "MMCFBlock::serialize_shard: empty shard" ) );
+
+ netCDF::NcDim nn = group.addDim( "NNodes" , get_NNodes() );
+ netCDF::NcDim na = group.addDim( "NArcs" , get_NArcs() );
+ netCDF::NcDim nc = group.addDim( "NComm" , comms.second - comms.first );
+ group.putAtt( "FirstComm" , netCDF::NcUint64() , FirstK + comms.first );
+
+ write_rows( group , comms , nc , na , nn );
+ }
+
+/*--------------------------------------------------------------------------*/
+
+void MMCFBlock::serialize_shards( const std::string & prefix ,
+				  Index nshards ) const
+{
+ if( ( ! nshards ) || ( nshards > NComm ) )
+  throw( std::invalid_argument(
+			  "MMCFBlock::serialize_shards: wrong shard number" ) );
+ {
+  netCDF::NcFile f( prefix + "topology.nc" , netCDF::NcFile::replace );
+  serialize_topology( f );
+  }
+
+ for( Index h = 0 ; h < nshards ; ++h ) {
+  netCDF::NcFile f( prefix + "shard" + std::to_string( h ) + ".nc" ,
+		    netCDF::NcFile::replace );
+  serialize_shard( f , Range( ( NComm * h ) / nshards ,
+			      ( NComm * ( h + 1 ) ) / nshards ) );
+  }
+ }
+
+/*--------------------------------------------------------------------------*/
+
 void MMCFBlock::deserialize( const netCDF::NcGroup & group )
 {
  // erase previous instance, if any- - - - - - - - - - - - - - - - - - - - - -
@@ -1640,6 +5334,73 @@ void MMCFBlock::deserialize( const netCDF::NcGroup & group )
 
  // read problem data- - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
+ read_topology( group );
+
+ if( group.getDim( "NCnst" ).isNull() )
+  throw( std::logic_error( "NCnst dimension is required" ) );
+
+ FirstK = NCommGlb = 0;  // not a shard
+ read_rows( group );
+
+ // common initializations- - - - - - - - - - - - - - - - - - - - - - - - - -
+ CmnIntlz();
+
+ // call the method of Block- - - - - - - - - - - - - - - - - - - - - - - - -
+ // inside this the NBModification, the "nuclear option",  is issued
+
+ Block::deserialize( group );
+
+ } // end( MMCFBlock::deserialize )
+
+/*--------------------------------------------------------------------------*/
+
+void MMCFBlock::deserialize_shard( const netCDF::NcGroup & topology ,
+				   const netCDF::NcGroup & shard )
+{
+ // ensure starting from clean slate
+ guts_of_destructor();
+
+ // read the data of the whole instance - - - - - - - - - - - - - - - - - - -
+
+ read_topology( topology );
+ NCommGlb = NComm;
+
+ // read the commodities of the shard - - - - - - - - - - - - - - - - - - - -
+
+ auto nn = shard.getDim( "NNodes" );
+ auto na = shard.getDim( "NArcs" );
+ if( nn.isNull() || na.isNull() || ( nn.getSize() != NNodes ) ||
+     ( na.getSize() != NArcs ) )
+  throw( std::logic_error( "shard and topology do not match" ) );
+
+ auto nc = shard.getDim( "NComm" );
+ if( nc.isNull() )
+  throw( std::logic_error( "NComm dimension is required" ) );
+ NComm = nc.getSize();
+
+ unsigned long long fk;
+ shard.getAtt( "FirstComm" ).getValues( & fk );
+ FirstK = fk;
+ if( ( ! NComm ) || ( FirstK + NComm > NCommGlb ) )
+  throw( std::logic_error( "wrong commodities in the shard" ) );
+
+ read_rows( shard );
+
+ // common initializations- - - - - - - - - - - - - - - - - - - - - - - - - -
+ CmnIntlz();
+
+ // issue Modification- - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ // note: this is a NBModification, the "nuclear option"
+
+ if( anyone_there() )
+  add_Modification( std::make_shared< NBModification >( this ) );
+
+ }  // end( MMCFBlock::deserialize_shard )
+
+/*--------------------------------------------------------------------------*/
+
+void MMCFBlock::read_topology( const netCDF::NcGroup & group )
+{
  auto nn = group.getDim( "NNodes" );
  if( nn.isNull() )
   throw( std::logic_error( "NNodes dimension is required" ) );
@@ -1655,64 +5416,118 @@ void MMCFBlock::deserialize( const netCDF::NcGroup & group )
   throw( std::logic_error( "NComm dimension is required" ) );
  NComm = nc.getSize();
  
- Index NCnst = NArcs;
- auto ncnst = group.getDim( "NCnst" );
- if( nc.isNull() )
-  throw( std::logic_error( "NCnst dimension is required" ) );
- NCnst = ncnst.getSize();
- 
  auto sn = group.getVar( "SN" );
  if( sn.isNull() )
   throw( std::logic_error( "Starting Nodes not found" ) );
 
- Startn.resize( NArcs );
- sn.getVar( Startn.data() );
+ Startn.mut().resize( NArcs );
+ sn.getVar( Startn.mut().data() );
 
  auto en = group.getVar( "EN" );
  if( en.isNull() )
   throw( std::logic_error( "Ending Nodes not found" ) );
 
- Endn.resize( NArcs );
- en.getVar( Endn.data() );
+ Endn.mut().resize( NArcs );
+ en.getVar( Endn.mut().data() );
  
  auto ut = group.getVar( "Utot" );
  if( ut.isNull() )
   throw( std::logic_error( "Total capacities not found" ) );
 
- UTot.resize( NArcs );
- ut.getVar( UTot.data() );
+ UTot.mut().resize( NArcs );
+ ut.getVar( UTot.mut().data() );
 
  auto fc = group.getVar( "F" );
  if( ! fc.isNull() ){
-  F.resize( NArcs );
-  fc.getVar( F.data() );
+  F.mut().resize( NArcs );
+  fc.getVar( F.mut().data() );
   }
+ }
 
- U.resize( NComm );
- for( int i = 0 ; i< NComm ; i++ )
-  U[ i ].resize( NArcs );
- 
- B.resize( NComm );
- for( int i = 0 ; i< NComm ; i++ )
-  B[ i ].resize(NNodes); 
- 
- C.resize( NComm );
- for( int i = 0 ; i< NComm ; i++)
-  C[ i ].resize( NArcs ); 
- 
- ::deserialize( group , "U" , U );
- ::deserialize( group , "B" , B );
- ::deserialize( group , "C" , C ); 
- 
- // common initializations- - - - - - - - - - - - - - - - - - - - - - - - - -
- CmnIntlz();
+/*--------------------------------------------------------------------------*/
 
- // call the method of Block- - - - - - - - - - - - - - - - - - - - - - - - -
- // inside this the NBModification, the "nuclear option",  is issued
+void MMCFBlock::read_rows( const netCDF::NcGroup & group )
+{
+ if( ! OOCFile.empty() ) {
+  // out-of-core: read one commodity at a time, moving it to the file
+  auto u = group.getVar( "U" );
+  auto b = group.getVar( "B" );
+  auto c = group.getVar( "C" );
+  if( u.isNull() || b.isNull() || c.isNull() )
+   throw( std::logic_error( "U, B and C are required" ) );
+
+  U.assign( NComm , {} );
+  B.assign( NComm , {} );
+  C.assign( NComm , {} );
+  ooc_open();
 
- Block::deserialize( group );
+  for( Index k = 0 ; k < NComm ; ++k ) {
+   Vec_FNumber uk( NArcs );
+   Vec_FNumber bk( NNodes );
+   Vec_CNumber ck( NArcs );
+   u.getVar( { k , 0 } , { 1 , NArcs } , uk.data() );
+   b.getVar( { k , 0 } , { 1 , NNodes } , bk.data() );
+   c.getVar( { k , 0 } , { 1 , NArcs } , ck.data() );
+   U[ k ] = std::move( uk );
+   B[ k ] = std::move( bk );
+   C[ k ] = std::move( ck );
+   ooc_store( k );
+   ooc_touch( k );
+   }
+  }
+ else {
+  FMultiVector u( NComm , Vec_FNumber( NArcs ) );
+  FMultiVector b( NComm , Vec_FNumber( NNodes ) );
+  CMultiVector c( NComm , Vec_CNumber( NArcs ) );
 
- } // end( MMCFBlock::deserialize )
+  ::deserialize( group , "U" , u );
+  ::deserialize( group , "B" , b );
+  ::deserialize( group , "C" , c );
+
+  to_shared( U , std::move( u ) );
+  to_shared( B , std::move( b ) );
+  to_shared( C , std::move( c ) );
+  }
+ }
+
+/*--------------------------------------------------------------------------*/
+
+void MMCFBlock::write_arcs( netCDF::NcGroup & group ,
+			    const netCDF::NcDim & na ) const
+{
+ ( group.addVar( "SN" , netCDF::NcUint64() , na ) ).putVar( Startn.data() );
+
+ ( group.addVar( "EN" , netCDF::NcUint64() , na ) ).putVar( Endn.data() );
+
+ ( group.addVar( "Utot" , netCDF::NcDouble() , na ) ).putVar( UTot.data() );
+
+ if( F.size() == NArcs )
+  ( group.addVar( "F" , netCDF::NcDouble() , na ) ).putVar( F.data() );
+ }
+
+/*--------------------------------------------------------------------------*/
+
+void MMCFBlock::write_rows( netCDF::NcGroup & group , Range comms ,
+			    const netCDF::NcDim & nc ,
+			    const netCDF::NcDim & na ,
+			    const netCDF::NcDim & nn ) const
+{
+ auto u = group.addVar( "U" , netCDF::NcDouble() , { nc , na } );
+ auto b = group.addVar( "B" , netCDF::NcDouble() , { nc , nn } );
+ auto c = group.addVar( "C" , netCDF::NcDouble() , { nc , na } );
+ for( Index k = comms.first ; k < comms.second ; ++k ) {
+  const Index h = k - comms.first;
+  const bool rsdnt = C[ k ].is_resident();
+  u.putVar( { h , 0 } , { 1 , NArcs } , U[ k ].data() );
+  b.putVar( { h , 0 } , { 1 , NNodes } , B[ k ].data() );
+  c.putVar( { h , 0 } , { 1 , NArcs } , C[ k ].data() );
+  if( ! rsdnt ) {
+   U[ k ].page_out();
+   B[ k ].page_out();
+   C[ k ].page_out();
+   }
+  }
+ }
 
 /*--------------------------------------------------------------------------*/
 
@@ -1734,42 +5549,215 @@ void MMCFBlock::CmnIntlz( void )
  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
  ActiveK.resize( NComm );
- NamesK.resize( NComm + 1 );
 
- for( NamesK[ 0 ] = NCnst , k = 0 ; k < NComm ; k++ ) {
-  // first, count how many active constraints there are - - - - - - - - - - -
+ if( ( ! OOCFile.empty() ) && ( ! OOCMap ) )  // move the data to the file
+  ooc_open();
+
+ for( k = 0 ; k < NComm ; k++ ) {
+  ooc_touch( k );
+  set_ActiveK( k );
+  }
+
+ set_NamesK();
+
+ // construct the forward star representation of the graph - - - - - - - -
+ // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+ FSBeg.assign( NNodes + 1 , 0 );
+ for( Index i = 0 ; i < NArcs ; i++ )
+  FSBeg[ Startn[ i ] - StrtNme + 1 ]++;
+ for( Index v = 0 ; v < NNodes ; v++ )
+  FSBeg[ v + 1 ] += FSBeg[ v ];
+
+ FSArc.resize( NArcs );
+ {
+  Subset pos( FSBeg.begin() , FSBeg.end() - 1 );
+  for( Index i = 0 ; i < NArcs ; i++ )
+   FSArc[ pos[ Startn[ i ] - StrtNme ]++ ] = i;
+  }
+
+ // find the trivial commodities- - - - - - - - - - - - - - - - - - - - - - -
+ // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+ find_trivial_commodities();
+
+ }  // end( CmnIntlz )
+
+/*--------------------------------------------------------------------------*/
+/*-------------------------- PRIVATE METHODS -------------------------------*/
+/*--------------------------------------------------------------------------*/
+
+void MMCFBlock::set_ActiveK( Index k )
+{
+ // first, count how many active constraints there are - - - - - - - - - - -
+
+ Index cnt = 0;
+ for( Index i = 0 ; i < NArcs ; i++ )
+  if( ( C[ k ][ i ] < Inf< CNumber >() ) &&
+      ( U[ k ][ i ] < Inf< FNumber >() ) )
+   cnt++;
 
-  Index i = 0;
-  Index cnt = 0;
-  // cCRow Ck = C[ k ];
-  // cFRow Uk = U[ k ];
+ // second, (if necessary) construct the actual vector of indices - - - - - -
 
-  for( ; i < NArcs ; i++ )
+ ActiveK[ k ].clear();
+ if( cnt < NArcs ) {
+  ActiveK[ k ].mut().reserve( cnt + 1 );
+  for( Index i = 0 ; i < NArcs ; i++ )
    if( ( C[ k ][ i ] < Inf< CNumber >() ) &&
        ( U[ k ][ i ] < Inf< FNumber >() ) )
-    cnt++;
+    ActiveK[ k ].mut().push_back( i );
 
-  // second, (if necessary) construct the actual vector of indices - - - - - -
+  ActiveK[ k ].mut().push_back( Inf< Index >() );
+  }
+ }
 
-  NamesK[ k + 1 ] = NamesK[ k ] + cnt;
+/*--------------------------------------------------------------------------*/
 
-  if( cnt < NArcs ) {
-   ActiveK[ k ].resize( cnt + 1 );
-   for( i = 0 ; i < NArcs ; i++ )
-    if( ( C[ k ][ i ] < Inf< CNumber >() ) &&
-	( U[ k ][ i ] < Inf< FNumber >() ) )
-     ActiveK[ k ].push_back( i );
+void MMCFBlock::set_NamesK( void )
+{
+ NamesK.resize( NComm + 1 );
+ NamesK[ 0 ] = NCnst;
+ for( Index k = 0 ; k < NComm ; k++ )
+  NamesK[ k + 1 ] = NamesK[ k ] + ( ActiveK[ k ].empty() ? NArcs :
+				    ActiveK[ k ].size() - 1 );
+ }
+
+/*--------------------------------------------------------------------------*/
+
+bool MMCFBlock::trivial_data( const Vec_CNumber & c , const Vec_FNumber & b )
+{
+ // a commodity is trivial if it has all-zero deficits and no negative-cost
+ // arc, since then the zero flow is optimal (there can be no negative-cost
+ // cycle) and nothing else is needed to represent it
+ return( std::all_of( b.begin() , b.end() ,
+		      []( FNumber bi ) { return( bi == 0 ); } ) &&
+	 std::none_of( c.begin() , c.end() ,
+		       []( CNumber ci ) { return( ci < 0 ); } ) );
+ }
 
-   ActiveK[ k ].push_back( Inf< Index >() );
+/*--------------------------------------------------------------------------*/
+
+void MMCFBlock::find_trivial_commodities( void )
+{
+ if( AR & HasVar )  // the formulation is already there
+  return;           // the set of formulated commodities cannot change
+
+ FrmlK.clear();
+ PosK.assign( NComm , Inf< Index >() );
+
+ for( Index k = 0 ; k < NComm ; ++k ) {
+  ooc_touch( k );
+  if( ! trivial_data( C[ k ] , B[ k ] ) ) {
+   PosK[ k ] = FrmlK.size();
+   FrmlK.push_back( k );
    }
-  else
-   ActiveK[ k ].clear();
+  }
 
-  }  // end( for( k ) )
- }  // end( CmnIntlz )
+ if( FrmlK.size() == NComm ) {  // no trivial commodity
+  FrmlK.clear();                // use the compact representation
+  PosK.clear();
+  }
+ }  // end( find_trivial_commodities )
 
 /*--------------------------------------------------------------------------*/
-/*-------------------------- PRIVATE METHODS -------------------------------*/
+
+void MMCFBlock::ooc_open( void )
+{
+ OOCLRU.clear();
+ OOCPos.clear();
+ OOCMap.reset();
+ OOCRows = 0;
+
+ // the file contains, for each commodity k, the rows C[ k ], U[ k ] and
+ // B[ k ] one after the other
+ const size_t rs = NArcs * ( sizeof( CNumber ) + sizeof( FNumber ) ) +
+                   NNodes * sizeof( FNumber );
+ const size_t sz = rs * NComm;
+ if( ! sz )
+  return;
+
+ int fd = ::open( OOCFile.c_str() , O_RDWR | O_CREAT | O_TRUNC , 0600 );
+ if( fd < 0 )
+  throw( std::runtime_error( "MMCFBlock: cannot open " + OOCFile ) );
+
+ if( ::ftruncate( fd , sz ) ) {
+  ::close( fd );
+  throw( std::runtime_error( "MMCFBlock: cannot resize " + OOCFile ) );
+  }
+
+ void * p = ::mmap( nullptr , sz , PROT_READ | PROT_WRITE , MAP_SHARED ,
+		    fd , 0 );
+ ::close( fd );  // the mapping does not need the descriptor
+ if( p == MAP_FAILED )
+  throw( std::runtime_error( "MMCFBlock: cannot map " + OOCFile ) );
+
+ OOCMap = std::shared_ptr< char >( static_cast< char * >( p ) ,
+				   [ sz ]( char * q ) { ::munmap( q , sz ); } );
+ OOCRows = NComm;
+ OOCPos.assign( NComm , OOCLRU.end() );
+
+ // store the rows that are already there (if any)
+ for( Index k = 0 ; k < NComm ; ++k )
+  if( ! C[ k ].empty() ) {
+   ooc_store( k );
+   ooc_touch( k );
+   }
+ }  // end( ooc_open )
+
+/*--------------------------------------------------------------------------*/
+
+void MMCFBlock::ooc_store( Index k )
+{
+ char * row = OOCMap.get() +
+  k * ( NArcs * ( sizeof( CNumber ) + sizeof( FNumber ) ) +
+	NNodes * sizeof( FNumber ) );
+ auto pc = reinterpret_cast< CNumber * >( row );
+ auto pu = reinterpret_cast< FNumber * >( pc + NArcs );
+ auto pb = reinterpret_cast< FNumber * >( pu + NArcs );
+
+ // the aliasing shared_ptr keeps the whole mapping alive, even after
+ // guts_of_destructor(), as long as any row refers to it
+
+ if( C[ k ].is_dirty() && ( C[ k ].size() == NArcs ) ) {
+  std::copy( C[ k ].begin() , C[ k ].end() , pc );
+  C[ k ].map( std::shared_ptr< const CNumber >( OOCMap , pc ) );
+  }
+
+ if( U[ k ].is_dirty() && ( U[ k ].size() == NArcs ) ) {
+  std::copy( U[ k ].begin() , U[ k ].end() , pu );
+  U[ k ].map( std::shared_ptr< const FNumber >( OOCMap , pu ) );
+  }
+
+ if( B[ k ].is_dirty() && ( B[ k ].size() == NNodes ) ) {
+  std::copy( B[ k ].begin() , B[ k ].end() , pb );
+  B[ k ].map( std::shared_ptr< const FNumber >( OOCMap , pb ) );
+  }
+ }  // end( ooc_store )
+
+/*--------------------------------------------------------------------------*/
+
+void MMCFBlock::ooc_touch( Index k )
+{
+ if( ( ! OOCMap ) || ( k >= OOCRows ) )
+  return;
+
+ if( OOCPos[ k ] != OOCLRU.end() )
+  OOCLRU.splice( OOCLRU.begin() , OOCLRU , OOCPos[ k ] );
+ else
+  OOCPos[ k ] = OOCLRU.insert( OOCLRU.begin() , k );
+
+ // drop the least recently used commodities, writing back their changes
+ while( OOCLRU.size() > OOCMaxRes ) {
+  const Index h = OOCLRU.back();
+  OOCLRU.pop_back();
+  OOCPos[ h ] = OOCLRU.end();
+  ooc_store( h );
+  C[ h ].page_out();
+  U[ h ].page_out();
+  B[ h ].page_out();
+  }
+ }  // end( ooc_touch )
+
 /*--------------------------------------------------------------------------*/
 
 void MMCFBlock::guts_of_destructor( void )
@@ -1791,9 +5779,44 @@ void MMCFBlock::guts_of_destructor( void )
    it->clear();
   }
 
+ {
+  const auto sup = HCs.data() + HCs.num_elements();
+  for( auto it = HCs.data() ; it != sup ; ++it )
+   it->clear();
+  }
+
+ for( auto & cnst : PathDCs )
+  cnst.clear();
+ for( auto & cnst : PathICs )
+  cnst.clear();
+ PathObj.clear();
+
  MCs.clear();
  FCs.resize( boost::extents[ 0 ][ 0 ] );
  SLCs.resize( boost::extents[ 0 ][ 0 ] );
+ HCs.resize( boost::extents[ 0 ][ 0 ] );
+ KnpItm.clear();
+ KnpScl.clear();
+ KnpMxF.clear();
+ KnpCst.clear();
+ MCArc.clear();
+ HybArcs.clear();
+ HybPos.clear();
+ RmvdK.clear();
+
+ PathDCs.clear();
+ PathICs.clear();
+ PathICBeg.clear();
+ PathICArc.clear();
+ PathVars.clear();
+ PathArcs.clear();
+ PathSlk.clear();
+ PathBigM.clear();
+ PathOrg.clear();
+ PathDst.clear();
+ PathDmd.clear();
+ PathGrps.clear();
+ PathPi.clear();
 
  for( auto bk : v_Block )
   delete bk;
@@ -1809,16 +5832,43 @@ void MMCFBlock::guts_of_destructor( void )
  B.clear();
  I.clear();
 
+ // the out-of-core setting (OOCFile, OOCMaxRes) is kept for the next
+ // instance, but the file of the current one is no longer used
+ OOCLRU.clear();
+ OOCPos.clear();
+ OOCMap.reset();
+ OOCRows = 0;
+
+ FirstK = NCommGlb = 0;  // not a shard
+ LgrLmb.clear();
+ SubNode.clear();
+ SubArc.clear();
+ SubComm.clear();
+ CrsNode.clear();
+ CrsArc.clear();
+ CrsComm.clear();
+ CrsArcW.clear();
+ CrsCommW.clear();
+
  UTot.clear();
  F.clear();
 
  Startn.clear();
  Endn.clear();
+ FSBeg.clear();
+ FSArc.clear();
 
  NamesK.clear();
  Active.clear();
  ActiveK.clear();
  PT.clear();
+ FrmlK.clear();
+ PosK.clear();
+
+ PPDone = false;
+ MaxFlwK.clear();
+ UTotOrg.clear();
+ USqzd.clear();
 
  CIsCpy.clear();
  UIsCpy.clear();
@@ -1829,10 +5879,13 @@ void MMCFBlock::guts_of_destructor( void )
  // a new instance: if not, the new representation would be added to the
  // (no longer current) one
  reset_static_constraints();
- // not needed, there isn't any - reset_static_variables();
+ // only the arc-path formulation has Variable and Objective
+ if( AR & PathFormulation ) {
+  reset_static_variables();
+  reset_dynamic_variables();
+  reset_objective();
+  }
  // not needed, there isn't any - reset_dynamic_constraints();
- // not needed, there isn't any - reset_dynamic_variables();
- // not needed, there isn't any - reset_objective();
 
  AR = 0;
  
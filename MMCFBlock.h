@@ -37,6 +37,14 @@
 #include "FRowConstraint.h"
 #include "Configuration.h"
 #include "Objective.h"
+#include "FRealObjective.h"
+#include "LinearFunction.h"
+
+#include <list>
+
+#include <memory>
+
+#include <string>
 
 /*--------------------------------------------------------------------------*/
 /*--------------------------- NAMESPACE ------------------------------------*/
@@ -60,6 +68,9 @@ namespace SMSpp_di_unipi_it
  using FNumber = MCFBlock::FNumber;
  using Vec_FNumber = MCFBlock::Vec_FNumber;
 
+ using c_Vec_CNumber_it = MCFBlock::c_Vec_CNumber_it;
+ using c_Vec_FNumber_it = MCFBlock::c_Vec_FNumber_it;
+
  using FMultiVector = std::vector< Vec_FNumber >;
  using CMultiVector = std::vector< Vec_CNumber >;
  using MultiSubset = std::vector< Block::Subset >;
@@ -73,6 +84,155 @@ namespace SMSpp_di_unipi_it
 /** @defgroup MMCFBlock_CLASSES Classes in MMCFBlock.h
  *  @{ */
 
+/*--------------------------------------------------------------------------*/
+/*------------------------- CLASS SharedVector -----------------------------*/
+/*--------------------------------------------------------------------------*/
+/// a std::vector< T > that is shared between copies until it is written
+/** A (reference-counted) handle to a std::vector< T >: copying the handle
+ * is O( 1 ) and the copies share the same data. All the const methods of
+ * std::vector that are needed are provided, and the handle converts to a
+ * const std::vector< T > &, so that it can be read as if it were one. Any
+ * change has to go through mut(), which first makes a private copy of the
+ * data if it is currently shared with any other handle (copy-on-write).
+ *
+ * The data can also have a "backing" copy out of core, i.e., in a memory
+ * mapped file [see map()]: then, as long as the data has not been changed
+ * since it was last written there, page_out() can free the memory, and the
+ * data is transparently read back from the backing copy when next used.
+ * Note that this invalidates any reference to the data previously obtained
+ * (by get(), data(), begin(), ...).
+ *
+ * This is used by MMCFBlock for the instance data, so that the clones of
+ * a MMCFBlock [see MMCFBlock::clone()] only take memory for the data they
+ * actually change, and so that the rows of the largest matrices can be
+ * kept out of core [see MMCFBlock::set_out_of_core()]. Since mut() only
+ * copies the data when it is shared, it is safe for different threads to
+ * change different handles to the same data, but not to concurrently use
+ * the same handle. */
+
+template< class T >
+class SharedVector
+{
+ public:
+
+ using Vec = std::vector< T >;
+ using const_iterator = typename Vec::const_iterator;
+ using size_type = typename Vec::size_type;
+ using value_type = T;
+
+ SharedVector( void ) : f_p( std::make_shared< Vec >() ) , f_n( 0 ) ,
+  f_dirty( false ) {}
+
+ SharedVector( Vec && v ) : f_p( std::make_shared< Vec >( std::move( v ) ) ) ,
+  f_n( 0 ) , f_dirty( false ) {}
+
+ SharedVector( const Vec & v ) : f_p( std::make_shared< Vec >( v ) ) ,
+  f_n( 0 ) , f_dirty( false ) {}
+
+ SharedVector( size_type n , const T & x = T() )
+  : f_p( std::make_shared< Vec >( n , x ) ) , f_n( 0 ) , f_dirty( false ) {}
+
+ SharedVector & operator=( Vec && v ) {
+  f_p = std::make_shared< Vec >( std::move( v ) );
+  f_map.reset();
+  return( *this );
+  }
+
+ /// read access to the data, reading it back from the backing if needed
+ const Vec & get( void ) const {
+  if( ! f_p )
+   f_p = std::make_shared< Vec >( f_map.get() , f_map.get() + f_n );
+  return( *f_p );
+  }
+
+ operator const Vec & ( void ) const { return( get() ); }
+
+ const T & operator[]( size_type i ) const { return( get()[ i ] ); }
+
+ size_type size( void ) const { return( f_p ? f_p->size() : f_n ); }
+
+ bool empty( void ) const { return( ! size() ); }
+
+ const T * data( void ) const { return( get().data() ); }
+
+ const_iterator begin( void ) const { return( get().cbegin() ); }
+
+ const_iterator end( void ) const { return( get().cend() ); }
+
+ const_iterator cbegin( void ) const { return( get().cbegin() ); }
+
+ const_iterator cend( void ) const { return( get().cend() ); }
+
+ const T & front( void ) const { return( get().front() ); }
+
+ const T & back( void ) const { return( get().back() ); }
+
+ bool operator==( const SharedVector & v ) const {
+  return( ( f_p && ( f_p == v.f_p ) ) || ( get() == v.get() ) );
+  }
+
+ /// true if the data is currently shared with other handles
+ bool is_shared( void ) const { return( f_p.use_count() > 1 ); }
+
+ /// write access to the data, unsharing it first if necessary
+ Vec & mut( void ) {
+  get();
+  if( f_p.use_count() > 1 )
+   f_p = std::make_shared< Vec >( *f_p );
+  f_dirty = true;
+  return( *f_p );
+  }
+
+ /// make this an empty vector, without touching the shared data
+ void clear( void ) {
+  f_p = std::make_shared< Vec >();
+  f_map.reset();
+  }
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+ /// set the backing copy of the data
+ /** Set the backing copy of the data, which must currently be identical to
+  * the size() elements starting from map; the shared_ptr keeps whatever
+  * contains the backing alive as long as it is needed (being typically an
+  * aliasing one to a memory-mapped file). */
+
+ void map( std::shared_ptr< const T > map ) {
+  f_n = size();
+  f_map = std::move( map );
+  f_dirty = false;
+  }
+
+ /// true if the data has been changed after map()
+ bool is_dirty( void ) const { return( f_dirty || ( ! f_map ) ); }
+
+ /// true if the data is currently in memory
+ bool is_resident( void ) const { return( bool( f_p ) ); }
+
+ /// free the memory of the data, if it has an up-to-date backing copy
+ bool page_out( void ) const {
+  if( is_dirty() )
+   return( false );
+  f_p.reset();
+  return( true );
+  }
+
+ /// drop the backing copy, reading the data back from it first if needed
+ void unmap( void ) {
+  get();
+  f_map.reset();
+  }
+
+ private:
+
+ mutable std::shared_ptr< Vec > f_p;
+ ///< the data, nullptr if it has been paged out
+
+ std::shared_ptr< const T > f_map;  ///< the backing copy, if any
+ size_type f_n;                     ///< the size of the backing copy
+ bool f_dirty;                      ///< true if changed after map()
+
+ };  // end( class( SharedVector ) )
+
 /*--------------------------------------------------------------------------*/
 /*-------------------------- CLASS MMCFBlock ------------------------------*/
 /*--------------------------------------------------------------------------*/
@@ -94,6 +254,43 @@ class MMCFBlock : public Block
 
  enum MCFType { kMCF , kSPT };
 
+/*--------------------------------------------------------------------------*/
+ /// what has been changed by an incremental PreProcess()
+ /** Structure describing the changes performed by the incremental version
+  * of PreProcess() [see PreProcess( c_Subset & , c_Subset & , PPChanges * )
+  * ], so that the caller can update any attached Solver accordingly rather
+  * than rebuilding everything from scratch. */
+
+ struct PPChanges {
+  Subset MutualOn;   ///< arcs whose mutual capacity constraint became active
+  Subset MutualOff;  ///< arcs whose mutual capacity constraint was dropped
+  Subset Comms;      ///< commodities whose set ActiveK[ k ] has changed
+  std::vector< std::pair< Index , Index > > Closed;
+  ///< ( commodity , arc ) pairs that have been declared un-existent
+  };
+
+/*--------------------------------------------------------------------------*/
+ /// the evaluation of a solution [see evaluate_solution()]
+ /** Structure describing the objective value of a solution, and how much
+  * it violates each family of constraints: the flow conservation ones (FC),
+  * the bounds 0 <= x^k_i <= u^k_i (IC) and the mutual capacities (MC). */
+
+ struct SolutionEval {
+  double Obj;    ///< the objective value, sum of C x + F y
+  double MaxFC;  ///< maximum violation of a flow conservation constraint
+  double SumFC;  ///< total violation of the flow conservation constraints
+  double MaxIC;  ///< maximum violation of a flow bound
+  double SumIC;  ///< total violation of the flow bounds
+  double MaxMC;  ///< maximum violation of a mutual capacity constraint
+  double SumMC;  ///< total violation of the mutual capacity constraints
+  std::vector< std::pair< Index , double > > TopArcs;
+  ///< the most violated arcs (flow bounds plus mutual capacity), by
+  ///< nonincreasing violation
+  std::vector< std::pair< Index , double > > TopNodes;
+  ///< the most violated nodes (flow conservation, summed over the
+  ///< commodities), by nonincreasing violation
+  };
+
 /*--------------------------------------------------------------------------*/
 /*--------------------- PUBLIC METHODS OF THE CLASS ------------------------*/
 /*--------------------------------------------------------------------------*/
@@ -106,7 +303,9 @@ class MMCFBlock : public Block
  /** Constructor of MMCFBlock. It accepts a pointer to the father
   * Block, which can be of any type. */
 
- MMCFBlock( Block *father = nullptr ) : Block( father ) , AR( 0 ) { }
+ MMCFBlock( Block *father = nullptr ) : Block( father ) , AR( 0 ) ,
+  PPDone( false ) , FirstK( 0 ) , NCommGlb( 0 ) , OOCMaxRes( 1 ) ,
+  OOCRows( 0 ) { }
 
 /*--------------------------------------------------------------------------*/
  /// destructor of MMCFBlock
@@ -164,6 +363,154 @@ class MMCFBlock : public Block
 
  void load( std::istream & input , char frmt = 0 ) override;
 
+/*--------------------------------------------------------------------------*/
+ /// load the MMCFBlock out of data already in memory
+ /** Load the MMCFBlock out of the given data, which is moved into the
+  * MMCFBlock (hence the caller's vectors are left empty) rather than copied,
+  * avoiding any round-trip through files. The data is:
+  *
+  * - nn, na, nc: the number of nodes, arcs and commodities;
+  *
+  * - sn, en: the start and end node of each arc, with node names in
+  *   1, ..., nn (as in all the file formats);
+  *
+  * - c, u, b: the nc x na arc costs, the nc x na individual arc capacities
+  *   and the nc x nn node deficits, with the same conventions as in the
+  *   file formats (Inf< CNumber >() cost for an arc that commodity k can not
+  *   use, Inf< FNumber >() for no individual capacity); b may be empty, in
+  *   which case all deficits are 0;
+  *
+  * - utot: the na mutual capacities, Inf< FNumber >() for no mutual
+  *   capacity constraint;
+  *
+  * - f: the na fixed costs; may be empty, meaning all 0.
+  *
+  * Exceptions are thrown if the sizes are not consistent. If there is any
+  * Solver attached to this MMCFBlock then a NBModification (the "nuclear
+  * option") is issued. */
+
+ void load( Index nn , Index na , Index nc , Subset && sn , Subset && en ,
+	    CMultiVector && c , FMultiVector && u , FMultiVector && b ,
+	    Vec_FNumber && utot , Vec_CNumber && f = {} );
+
+/*--------------------------------------------------------------------------*/
+ /// returns a new MMCFBlock with the same instance, sharing its data
+ /** Returns a new MMCFBlock (with the given father, if any) that has the
+  * same instance as this one, including the effects of PreProcess() and of
+  * all the changes performed so far. The instance data (topology, costs,
+  * capacities, deficits and the sets of active arcs) is not copied but
+  * shared between the two [see SharedVector], and each one only makes its
+  * private copy of a row (e.g., the costs of one commodity) if and when it
+  * changes it; thus, the memory taken by the clone is close to that of what
+  * actually differs. The abstract representation is not cloned: it is
+  * constructed from scratch, as usual, if and when the generate_abstract_*
+  * methods are called on the clone, and neither are the BlockConfig and the
+  * registered Solver. Different clones (and the original) can then be used
+  * (and changed) by different threads; the new MMCFBlock belongs to the
+  * caller. In out-of-core mode [see set_out_of_core()] the rows of the
+  * clone are read in memory, since the file of this MMCFBlock is rewritten
+  * as its rows change. */
+
+ MMCFBlock * clone( Block * father = nullptr ) const;
+
+/*--------------------------------------------------------------------------*/
+ /// returns a new MMCFBlock with the sub-instance over comms and arcs
+ /** Returns a new MMCFBlock (with the given father, if any) whose instance
+  * is the restriction of this one to the commodities in comms and to the
+  * arcs in arcs (either being empty meaning "all"), and to the nodes that
+  * are endpoints of some arc in arcs; the new MMCFBlock belongs to the
+  * caller. Only the data that is actually restricted is copied, all the
+  * rest (e.g., all the rows of the costs, capacities and deficits of the
+  * chosen commodities, if arcs is empty) being shared with this MMCFBlock
+  * as in clone() (and likewise read in memory in out-of-core mode). The
+  * data is the original one, i.e., the capacities squeezed by PreProcess()
+  * (if any) are restored; PreProcess() can be called on the sub-instance
+  * if needed. Note that when the arcs are restricted the deficits of the
+  * nodes are just copied, and therefore they may not make sense (e.g., not
+  * sum to zero) for the sub-instance: typically one then sets them [see
+  * chg_deficits()] out of a known flow in the rest of the graph.
+  *
+  * The sub-instance records the maps between its nodes, arcs and
+  * commodities and these of this MMCFBlock [see global_node(),
+  * local_node() and the likes], so that e.g. its flows and potentials can
+  * be mapped back. */
+
+ MMCFBlock * extract( c_Subset & comms , c_Subset & arcs ,
+		      Block * father = nullptr ) const;
+
+/*--------------------------------------------------------------------------*/
+ /// returns a new, coarser MMCFBlock clustering the nodes as in clst
+ /** Returns a new MMCFBlock (with the given father, if any), belonging to
+  * the caller, whose instance is obtained from this one by merging the
+  * nodes into clusters, clst[ v ] being the cluster (in 0, 1, ...) of node
+  * v (0-based) [see cluster_nodes()]; clst must have get_NNodes() entries,
+  * or else std::invalid_argument is thrown. In the coarse instance:
+  *
+  * - each cluster is a node, and all the arcs with the same clusters as
+  *   endpoints become one arc, whose mutual (individual) capacity is the
+  *   sum of theirs and whose (fixed) cost is the minimum of theirs; the
+  *   arcs inside a cluster are dropped;
+  *
+  * - the deficit of a cluster is the sum of these of its nodes, and all the
+  *   commodities with the same coarse costs and the same clusters with
+  *   negative (positive) deficit become one commodity, whose deficits and
+  *   individual capacities are the sum of theirs; the commodities that have
+  *   all zero deficits in the coarse instance are dropped.
+  *
+  * The data is the original one, as in extract(). The coarse MMCFBlock
+  * records the maps from this instance to itself [see coarse_node(),
+  * coarse_arc() and coarse_comm()], which are used to map its solution
+  * back to this instance as a warm start [see prolong_flows() and
+  * prolong_potentials()]; coarsen() can be called on it in turn to build a
+  * hierarchy of coarser instances. */
+
+ MMCFBlock * coarsen( c_Subset & clst , Block * father = nullptr ) const;
+
+/*--------------------------------------------------------------------------*/
+ /// clusters of the nodes for coarsen(), at most nn if possible
+ /** Returns the clusters of the nodes in the format required by coarsen(),
+  * computed by repeated matching: at each pass the arcs are scanned by
+  * nonincreasing mutual capacity, and two clusters are merged if neither
+  * has been merged yet in the pass. This stops as soon as there are at most
+  * nn clusters, or a pass does not merge anything. */
+
+ Subset cluster_nodes( Index nn ) const;
+
+/*--------------------------------------------------------------------------*/
+ /// keep the costs, capacities and deficits in a memory-mapped file
+ /** Sets the "out-of-core" mode, for instances whose (per-commodity) costs
+  * C, individual capacities U and deficits B do not fit in memory. The rows
+  * C[ k ], U[ k ] and B[ k ] of all the commodities are kept in the file
+  * fname (which is created, or overwritten, as needed), memory-mapped, and
+  * only these of the (at most) maxres commodities most recently used by the
+  * commodity-wise loops of the MMCFBlock (loading, PreProcess(), lazy
+  * construction of the MCFBlock [see LazySubBlocks], ...) are kept in
+  * memory; the others are read back from the file if and when they are
+  * accessed, and any change to them is written back to the file when they
+  * are dropped from memory. In particular, deserialize() reads the rows of
+  * one commodity at a time and serialize() writes them in the same way.
+  *
+  * The setting is persistent: it is applied to any instance loaded after
+  * the call, and also to the current one (if any). Calling this with an
+  * empty fname reads all the data back in memory and ends the mode. Note
+  * that:
+  *
+  * - the detection of commodities with identical data in PreProcess() is
+  *   not performed in this mode, since it would read all the data;
+  *
+  * - the references returned by get_C(), get_U() and get_B() remain valid
+  *   only until the row is dropped from memory;
+  *
+  * - the commodities added by add_commodity() after the file has been
+  *   created, as well as the clones [see clone()] and the sub-instances
+  *   [see extract()], keep their data in memory (the latter two reading
+  *   all the rows when they are constructed);
+  *
+  * - the arc-wise loops (e.g. these constructing the knapsack formulation)
+  *   read the data of all the commodities, and therefore do not stream. */
+
+ void set_out_of_core( const std::string & fname , Index maxres = 1 );
+
 /*--------------------------------------------------------------------------*/
  /// extends Block::deserialize( netCDF::NcGroup )
  /** Extends Block::deserialize( netCDF::NcGroup ) to the specific format of
@@ -171,6 +518,26 @@ class MMCFBlock : public Block
 
  void deserialize( const netCDF::NcGroup & group ) override;
 
+/*--------------------------------------------------------------------------*/
+ /// load one shard of an instance [see serialize_shard()]
+ /** Loads into the MMCFBlock only the commodities of one shard of an
+  * instance, as written by serialize_topology() (in the group topology) and
+  * serialize_shard() (in the group shard). The graph and the mutual
+  * capacities are those of the whole instance, but the MMCFBlock only has
+  * the get_NComm() commodities of the shard, its commodity k being the
+  * commodity get_FirstComm() + k of the whole instance (which has
+  * get_NCommGlobal() commodities); get_flow() takes the indices of the
+  * whole instance, get_local_flow() these of the MMCFBlock. Since the other
+  * commodities are not there, the mutual capacity constraints of the
+  * MMCFBlock are a relaxation of those of the whole instance, which is what
+  * a decomposition approach (e.g., a Lagrangian one dualizing them) needs.
+  * This honours the out-of-core mode [see set_out_of_core()]. If there is
+  * any Solver attached to this MMCFBlock then a NBModification (the
+  * "nuclear option") is issued. */
+
+ void deserialize_shard( const netCDF::NcGroup & topology ,
+			 const netCDF::NcGroup & shard );
+
 /*--------------------------------------------------------------------------*/
  /// simplifies the problem
  /** Performs various pre-processing of the data, trying to make the instance
@@ -205,19 +572,65 @@ class MMCFBlock : public Block
   * in the graph. In order to do that, *all arcs* with potentially *negative
   * costs* (ChgCsts is used to estimate that) must have a *finite capacity*.
   *
+  * Since arcs may be declared un-existent, PreProcess() also re-examines
+  * which commodities are "trivial" [see is_trivial()].
+  *
   * PreProcess() will also look for redundancy in the data structures (e.g.
   * identical costs/deficits/individual capacities for some commodities) and
   * eliminate them, thus possibly saving some memory.
   *
-  * It can be called *only once*. The ideal would be that it is automatically
-  * called after load(), deserialize() ecc. but this would not allow to set
-  * the proper parameters, therefore it has to be done independently (if
-  * ever). */
+  * The original values of the capacities that are squeezed are recorded, so
+  * that PreProcess() can be called again (say, with different parameters):
+  * each call restarts from the original data. Note, however, that arcs
+  * declared un-existent stay so, which is correct as long as the data only
+  * changes within the limits given by the parameters. The ideal would be
+  * that it is automatically called after load(), deserialize() ecc. but
+  * this would not allow to set the proper parameters, therefore it has to
+  * be done independently (if ever). */
 
  void PreProcess( FNumber IncUk = 0 , FNumber DecUk = 0 ,
 		  FNumber IncUjk = 0 , FNumber DecUjk = 0 ,
 		  FNumber ChgDfct = 0 , CNumber DecCsts = 0 );
 
+/*--------------------------------------------------------------------------*/
+ /// incrementally re-runs the pre-processing after some data has changed
+ /** Re-runs the pre-processing, with the same parameters as the last call to
+  * the full PreProcess() (that must have been called already, or exception
+  * is thrown), after the data of the arcs in \p arcs (for all commodities)
+  * and that of the commodities in \p comms (for all arcs) has changed. Only
+  * the decisions that may be affected by the changes are recomputed, i.e.,
+  *
+  * - the individual capacity constraints of the commodities in \p comms,
+  *   and those of all the commodities on the arcs in \p arcs;
+  *
+  * - the mutual capacity constraints of the arcs in \p arcs; however, if
+  *   the rough estimate of the maximum flow of some commodity changes (say,
+  *   because its deficits or the capacities of its negative-cost arcs have
+  *   changed), then all the mutual capacity constraints are re-examined.
+  *
+  * Active, NCnst, ActiveK and NamesK are updated accordingly. It is
+  * expected that the data is changed by the methods of the class, which
+  * take care of updating the records of the original (non-squeezed) values
+  * of the capacities: a derived class writing directly in UTot[] and U[]
+  * must update UTotOrg and USqzd as well.
+  *
+  * If \p chgs is not nullptr, it is filled with the description of what
+  * has changed [see PPChanges]. If the abstract representation has already
+  * been constructed, the arcs that are declared un-existent are closed in
+  * the corresponding MCFBlock (flow formulation) or have their variable
+  * fixed to 0 (knapsack formulation), which issues the corresponding
+  * Modification. The squeezed or restored capacities are also put in the
+  * abstract representation, as by chg_mutual_capacity() and
+  * chg_commodity_capacity(); since its constraints are static, if this is
+  * not possible (say, an arc whose mutual capacity constraint becomes
+  * active has no row in the flow formulation) std::logic_error is thrown,
+  * after having restored all the data as it was before the call and having
+  * cleared \p chgs. In out-of-core mode, this requires to keep a resident
+  * copy of all the rows of C[] and U[] during the call. */
+
+ void PreProcess( c_Subset & arcs , c_Subset & comms ,
+		  PPChanges * chgs = nullptr );
+
 /*--------------------------------------------------------------------------*/
  /// generate the "abstract representation" of the Variable of the Block
  /** This method generates the "abstract representation" of the Variable of
@@ -230,13 +643,68 @@ class MMCFBlock : public Block
   *
   * - [1]: the standard knapsack formulation in which get_NArcs()
   *   BinaryKnapsackBlock sub-Block are constructed, one for each commodity,
-  *   and the flow constraints are handled in the father MMCFBlock;
+  *   and the flow constraints are handled in the father MMCFBlock; the
+  *   knapsack of each arc only has the items of the commodities that can
+  *   use it (finite cost and nonzero capacity), each scaled by the tightest
+  *   bound available on its flow;
   *
   * - [0]: the standard flow formulation in which get_NComm() MCFBlock
   *   sub-Block are constructed, one for each commodity, and the
   *   linking constraints are handled in the father MMCFBlock;
   *
+  * - [2]: the arc-path formulation, where no sub-Block is constructed and
+  *   the MMCFBlock directly has one dynamic ColVariable for each path of
+  *   each commodity (the flow on the path), besides one static artificial
+  *   ColVariable per commodity (the unrouted demand, at a cost larger than
+  *   that of any path). The static constraints are the mutual capacity
+  *   ones over the path flows, the demand constraints (the flows on the
+  *   paths of a commodity plus its artificial variable sum to the demand)
+  *   and the individual capacity constraints for the arcs whose individual
+  *   capacity is smaller than the demand. Initially each commodity only has
+  *   its shortest path (w.r.t. the costs), new paths being generated by
+  *   price_paths(). This requires each (non-trivial) commodity to have
+  *   exactly one origin (node with negative deficit) and exactly one
+  *   destination (node with positive deficit), otherwise exception is
+  *   thrown. In this formulation the MMCFBlock has its own Objective.
+  *
+  * - [3]: the hybrid formulation, in which the get_NComm() MCFBlock of the
+  *   flow formulation are constructed, plus one BinaryKnapsackBlock (as in
+  *   the knapsack formulation) for each arc of a given subset H. For each
+  *   arc i in H and each commodity k, the flow variable x^k_i of the
+  *   MCFBlock is linked to the knapsack variable z^k_i by the static copy
+  *   constraint x^k_i = s^k_i z^k_i, with the scale s^k_i =
+  *   min( U[ k ][ i ] , UTot[ i ] ) (which must be finite); the mutual
+  *   capacity constraint (and, in the design case, the fixed cost) of the
+  *   arcs in H is handled by the knapsack, while that of the other arcs is
+  *   handled by MCs as in the flow formulation, the costs C staying in the
+  *   MCFBlock. With a SimpleConfiguration< int > the set H is that of the
+  *   arcs with an active mutual capacity constraint (Active, if PreProcess()
+  *   has been called, all those with finite UTot otherwise); H can be
+  *   explicitly given by using a SimpleConfiguration< std::vector< int > >,
+  *   whose first element is 3 and the others are the names of the arcs in
+  *   H. get_flow(), get_potential() and get_dual() work as in the flow
+  *   formulation, except that get_dual() returns the dual value of the
+  *   knapsack constraint for the arcs in H.
+  *
   * - [other ones possibly to follow].
+  *
+  * In all formulations only the non-trivial commodities [see is_trivial()]
+  * are represented, hence e.g. in the flow formulation there are only
+  * get_NFrmlK() MCFBlock sub-Block.
+  *
+  * Adding 4 to the formulation (i.e., 4 for [0] and 7 for [3]) asks for
+  * the MCFBlock of the commodities to be constructed lazily: initially the
+  * corresponding entries of v_Block are nullptr, and each MCFBlock is only
+  * constructed (together with whatever of its abstract representation
+  * has already been generated in the MMCFBlock) when it is first needed,
+  * i.e., by generate_sub_Block(), or by any method requiring its Variable,
+  * such as get_flow_variable(). Changes to the data of a commodity whose
+  * MCFBlock is not there only change the data. Since the mutual capacity
+  * (and copy) constraints involve the flow variables of all commodities,
+  * generate_abstract_constraints() constructs all the MCFBlock that are
+  * still missing; hence, this is most useful for whoever only works with
+  * some of the sub-Block (or only with the data). The flag is ignored by
+  * the knapsack and arc-path formulations.
   * 
   *  by default is considered the Flow relaxation
   */
@@ -249,9 +717,70 @@ class MMCFBlock : public Block
   override;
 
 /*--------------------------------------------------------------------------*/
- /*!! not needed yet, the version of Block suffices so far
+ /// generate the Objective of the MMCFBlock
+ /** In the flow and knapsack formulations the Objective is that of the
+  * sub-Block, and this just calls the method of Block. In the arc-path
+  * formulation the MMCFBlock has its own (linear) Objective, which is
+  * constructed here. */
+
  void generate_objective( Configuration * objc = nullptr ) override;
- !!*/
+
+/*--------------------------------------------------------------------------*/
+ /// generates new paths in the arc-path formulation
+ /** Prices out new paths in the arc-path formulation [see
+  * generate_abstract_variables()], which must have been constructed,
+  * together with the constraints, otherwise exception is thrown. For each
+  * commodity k, the reduced cost of arc i is
+  *
+  *     C[ k ][ i ] - lambda_i - mu_ki
+  *
+  * where lambda_i is the dual value of the mutual capacity constraint of
+  * arc i (0 if there is none) and mu_ki that of the individual capacity
+  * constraint of commodity k on arc i (0 if there is none), as currently
+  * read by get_dual() of the corresponding constraints. A shortest path
+  * tree w.r.t. these reduced costs is computed, with a label-correcting
+  * algorithm that allows negative reduced costs (but not negative cycles),
+  * out of the origin of each commodity; commodities having the same origin,
+  * the same costs and no individual capacity constraint share the same
+  * tree. If the reduced cost of the shortest path, minus the dual value of
+  * the demand constraint, is < - eps, the path is added as a new dynamic
+  * ColVariable, issuing the corresponding Modification as dictated by
+  * issueMod. The shortest path distances are also used as node potentials
+  * [see get_potential()]. Returns the number of paths added, so that 0
+  * means that the current solution is optimal (provided that the dual
+  * values are). */
+
+ Index price_paths( double eps = 1e-9 , ModParam issueMod = eModBlck );
+
+/*--------------------------------------------------------------------------*/
+ /// tells if the sub-Block in position h has been constructed
+ /** Tells if the sub-Block in position h of v_Block has been constructed;
+  * this is always true unless the MCFBlock of the commodities are
+  * constructed lazily [see generate_abstract_variables()]. */
+
+ bool has_sub_Block( Index h ) const {
+  return( ( h < v_Block.size() ) && v_Block[ h ] );
+  }
+
+/*--------------------------------------------------------------------------*/
+ /// returns the sub-Block in position h, constructing it if necessary
+ /** Returns the sub-Block in position h of v_Block (h < get_NFrmlK() being
+  * the MCFBlock of commodity p2k( h ) in the flow and hybrid formulations),
+  * constructing it first if the sub-Block are constructed lazily and it is
+  * not there yet [see generate_abstract_variables()]. The new MCFBlock is
+  * given the current data of the commodity, and whatever of its abstract
+  * representation (Variable, Constraint, Objective) has already been
+  * generated in the MMCFBlock; no Modification is issued. */
+
+ Block * generate_sub_Block( Index h );
+
+/*--------------------------------------------------------------------------*/
+ /// constructs the sub-Block in the positions in hs [see generate_sub_Block]
+
+ void generate_sub_Blocks( c_Subset & hs ) {
+  for( auto h : hs )
+   generate_sub_Block( h );
+  }
 
 /** @} ---------------------------------------------------------------------*/
 /*--------------- METHODS FOR PRINTING & SAVING THE MMCFBlock --------------*/
@@ -278,6 +807,41 @@ class MMCFBlock : public Block
 
  void serialize( netCDF::NcGroup & file ) const override;
 
+/*--------------------------------------------------------------------------*/
+ /// write the data common to all the shards of the instance
+ /** Writes into the group the data of the instance that does not depend on
+  * the commodities, and therefore is common to all the shards [see
+  * serialize_shard()]: the dimensions NNodes, NArcs and NComm (the total
+  * number of commodities), and the variables SN, EN, Utot and (if any) F,
+  * with the same meaning as in serialize(). For a shard [see
+  * deserialize_shard()], this is the topology of the whole instance. */
+
+ void serialize_topology( netCDF::NcGroup & group ) const;
+
+/*--------------------------------------------------------------------------*/
+ /// write the commodities in comms as a shard of the instance
+ /** Writes into the group the data of the commodities in the Range comms:
+  * the dimensions NNodes, NArcs and NComm (the number of commodities in
+  * the shard), the attribute FirstComm (the index in the whole instance of
+  * the first commodity of the shard) and the variables U, B and C, with the
+  * same meaning as in serialize(). The rows are written one commodity at a
+  * time, so that this streams in out-of-core mode [see set_out_of_core()].
+  * If this MMCFBlock is itself a shard, the indices in comms are local to
+  * it, but FirstComm is global. */
+
+ void serialize_shard( netCDF::NcGroup & group , Range comms ) const;
+
+/*--------------------------------------------------------------------------*/
+ /// write the instance as a topology file and nshards shard files
+ /** Writes the instance as the netCDF file prefix + "topology.nc" [see
+  * serialize_topology()] and the nshards netCDF files prefix + "shard" + h
+  * + ".nc", h = 0, ..., nshards - 1 [see serialize_shard()], the
+  * commodities being split in nshards contiguous ranges of (almost) equal
+  * size. The worker h of a decomposition then only needs to
+  * deserialize_shard() the topology file and the shard file h. */
+
+ void serialize_shards( const std::string & prefix , Index nshards ) const;
+
 /** @} ---------------------------------------------------------------------*/
 /*-------------- Methods for reading the data of the MCFBlock --------------*/
 /*--------------------------------------------------------------------------*/
@@ -298,12 +862,173 @@ class MMCFBlock : public Block
 
  Index get_NComm( void ) const { return( NComm ); }
 
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+ /// node (0-based) of the original instance of node n [see extract()]
+
+ Index global_node( Index n ) const {
+  return( SubNode.empty() ? n : SubNode[ n ] );
+  }
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+ /// node (0-based) corresponding to node gn of the original instance
+ /** Node (0-based) of the sub-instance [see extract()] corresponding to the
+  * node gn (0-based) of the instance it has been extracted from,
+  * Inf< Index >() if none. */
+
+ Index local_node( Index gn ) const { return( sub_index( SubNode , gn ) ); }
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+ /// arc of the original instance of arc i [see extract()]
+
+ Index global_arc( Index i ) const {
+  return( SubArc.empty() ? i : SubArc[ i ] );
+  }
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+ /// arc corresponding to arc gi of the original instance, Inf if none
+
+ Index local_arc( Index gi ) const { return( sub_index( SubArc , gi ) ); }
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+ /// commodity of the original instance of commodity k [see extract()]
+
+ Index global_comm( Index k ) const {
+  return( SubComm.empty() ? k : SubComm[ k ] );
+  }
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+ /// commodity corresponding to commodity gk of the original one, Inf if none
+
+ Index local_comm( Index gk ) const { return( sub_index( SubComm , gk ) ); }
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+ /// node of this coarse instance of node fv of the fine one [see coarsen()]
+ /** Node of this instance of the node fv (0-based) of the instance it has
+  * been coarsened from; fv itself if this instance is not a coarse one. */
+
+ Index coarse_node( Index fv ) const {
+  return( CrsNode.empty() ? fv : CrsNode[ fv ] );
+  }
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+ /// arc of this coarse instance of arc fi of the fine one, Inf if none
+
+ Index coarse_arc( Index fi ) const {
+  return( CrsNode.empty() ? fi : CrsArc[ fi ] );
+  }
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+ /// commodity of this coarse instance of commodity fk, Inf if none
+
+ Index coarse_comm( Index fk ) const {
+  return( CrsNode.empty() ? fk : CrsComm[ fk ] );
+  }
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+ /// index in the whole instance of commodity 0 [see deserialize_shard()]
+
+ Index get_FirstComm( void ) const { return( FirstK ); }
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+ /// number of commodities of the whole instance [see deserialize_shard()]
+
+ Index get_NCommGlobal( void ) const {
+  return( NCommGlb ? NCommGlb : NComm );
+  }
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+ /// get the number of commodities that are actually formulated
+ /** Returns the number of commodities that are actually represented in the
+  * formulation, i.e., get_NComm() minus the number of the "trivial" ones
+  * [see is_trivial()]. */
+
+ Index get_NFrmlK( void ) const {
+  return( PosK.empty() ? NComm : Index( FrmlK.size() ) );
+  }
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+ /// tells if commodity k is "trivial"
+ /** Returns true if commodity k is "trivial", i.e., its deficit vector
+  * B[ k ] is all zero (which also covers the case of a commodity whose
+  * origin and destination coincide) and it has no existing arc with
+  * negative cost. The optimal flow of such a commodity is identically
+  * zero, hence it is not represented at all in the formulation: get_flow()
+  * and get_potential() return 0 for it, get_flow_variable() returns
+  * nullptr and set_potential() does nothing. */
+
+ bool is_trivial( Index k ) const {
+  return( ( ! PosK.empty() ) && ( PosK[ k ] == Inf< Index >() ) );
+  }
+
+/*--------------------------------------------------------------------------*/
+ /// the start nodes of the arcs (names in 1, ..., get_NNodes())
+
+ const Subset & get_Startn( void ) const { return( Startn ); }
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+ /// the end nodes of the arcs (names in 1, ..., get_NNodes())
+
+ const Subset & get_Endn( void ) const { return( Endn ); }
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+ /// the arc costs of commodity k
+
+ const Vec_CNumber & get_C( Index k ) const { return( C[ k ] ); }
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+ /// the individual arc capacities of commodity k
+
+ const Vec_FNumber & get_U( Index k ) const { return( U[ k ] ); }
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+ /// the node deficits of commodity k
+
+ const Vec_FNumber & get_B( Index k ) const { return( B[ k ] ); }
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+ /// the mutual capacities of the arcs
+
+ const Vec_FNumber & get_UTot( void ) const { return( UTot ); }
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+ /// the fixed costs of the arcs (possibly empty, meaning all 0)
+
+ const Vec_CNumber & get_F( void ) const { return( F ); }
+
+/*--------------------------------------------------------------------------*/
+ /// tells if commodity k has been removed [see remove_commodity()]
+
+ bool is_removed( Index k ) const {
+  return( ( ! RmvdK.empty() ) && RmvdK[ k ] );
+  }
+
 /*--------------------------------------------------------------------------*/
 
  bool useFlowRelaxation( void ) const {
-  return( ! ( AR & KnapsackRelaxation ) );
+  return( ! ( AR & ( KnapsackRelaxation | PathFormulation ) ) );
+ }
+
+/*--------------------------------------------------------------------------*/
+
+ bool usePathFormulation( void ) const {
+  return( AR & PathFormulation );
+ }
+
+/*--------------------------------------------------------------------------*/
+
+ bool useHybridFormulation( void ) const {
+  return( AR & HybridFormulation );
  }
 
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+ /// number of paths currently in the arc-path formulation for commodity k
+
+ Index get_NPaths( Index k ) const {
+  if( ( ! ( AR & PathFormulation ) ) || is_trivial( k ) )
+   return( 0 );
+  return( PathArcs[ k2p( k ) ].size() );
+  }
+
 /*--------------------------------------------------------------------------*/
  /// getting the current sense of the Objective, which is minimization
 
@@ -314,46 +1039,114 @@ class MMCFBlock : public Block
   /*--------------------------------------------------------------------------*/
 
 
- /// get the flow of a given arc for a given commodity 
+ /// get the flow of a given arc for a given local commodity
  /** Given a commodity index k and an arc index ij, this function provides
-  * the value of the associated variable x^k_ij. In the case of the knapsack
+  * the value of the associated variable x^k_ij, k being the index of the
+  * commodity in this MMCFBlock (the same as in get_flow() unless it is a
+  * shard [see deserialize_shard()]). In the case of the knapsack
   * relaxation, the variables of the block are rescaled in such a way that
   * x \in [ 0 , 1 ]. In this case the functions get_flow provide the values
-  * already rescaled wigth x^k_{ij} in [ 0 , u_ij ]. */
+  * already rescaled wigth x^k_{ij} in [ 0 , s^k_ij ], where the scale
+  * s^k_ij is the minimum among u^k_ij, the mutual capacity of ij and a bound
+  * on the flow of k; the flow of the commodities that can not use ij (which
+  * have no knapsack item) is 0. */
 
- double get_flow( Index k , Index i ) const {
+ double get_local_flow( Index k , Index i ) const {
   if( ! ( AR & HasVar ) )
    return( 0 );
- 
-  if( ! ( AR & KnapsackRelaxation ) )
-   return( static_cast< MCFBlock * >( v_Block[ k ] )->get_x( i ) );
+
+  if( ( k < NComm ) && is_trivial( k ) )
+   return( 0 );
+
+  if( AR & PathFormulation )
+   return( k < NComm ? path_flow( k2p( k ) , i ) : 0 );
+
+  if( ! ( AR & KnapsackRelaxation ) ) {
+   if( k == NComm )  // the design variables only exist in hybrid knapsacks
+    return( in_hybrid( i ) ? hyb_block( i )->get_x( get_NFrmlK() ) : 0 );
+   auto MCFb = v_Block[ k2p( k ) ];  // a MCFBlock not constructed yet
+   return( MCFb ? static_cast< MCFBlock * >( MCFb )->get_x( i ) : 0 );
+   }
   else {
-   auto xk = static_cast< BinaryKnapsackBlock * >( v_Block[ i ] )->get_x( k );
-   return( k == NComm ? xk : U[ k ][ i ] * xk );
+   auto BKb = static_cast< BinaryKnapsackBlock * >( v_Block[ i ] );
+   if( k == NComm )
+    return( has_design() ? BKb->get_x( KnpItm[ i ].size() ) : 0 );
+   const auto t = knp_item( k2p( k ) , i );
+   return( t < Inf< Index >() ? KnpScl[ i ][ t ] * BKb->get_x( t ) : 0 );
    }
   }
 
 /*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/ 
- /// get the value of all flow variables associated to a given commodity
+ /// get the value of all flow variables of a given local commodity
 
- void get_flow( std::vector< double > & fk , Index k ) const {
-  if( ! ( AR & HasVar ) ) {
+ void get_local_flow( std::vector< double > & fk , Index k ) const {
+  if( ( ! ( AR & HasVar ) ) || ( ( k < NComm ) && is_trivial( k ) ) ) {
    std::fill( fk.begin(), fk.end() , 0 );
    return;
    }
 
-  if( ! ( AR & KnapsackRelaxation ) )
-   static_cast<MCFBlock *>( v_Block[ k ] )->get_x( fk.begin() ,
-						   Range( 0 , NArcs ) );
-  else
-   if( k == NComm )
-    for( Index i = 0 ; i < NArcs ; ++i )
-     fk[ i ] = static_cast< BinaryKnapsackBlock * >(
-						  v_Block[ i ] )->get_x( k );
+  if( AR & PathFormulation ) {
+   std::fill( fk.begin(), fk.end() , 0 );
+   if( k < NComm )
+    path_flow( k2p( k ) , fk );
+   return;
+   }
+
+  if( ! ( AR & KnapsackRelaxation ) ) {
+   if( k == NComm ) {  // the design variables only exist in hybrid knapsacks
+    std::fill( fk.begin(), fk.end() , 0 );
+    for( auto i : HybArcs )
+     fk[ i ] = hyb_block( i )->get_x( get_NFrmlK() );
+    }
    else
-    for( Index i = 0 ; i < NArcs ; ++i )
-     fk[ i ] = U[ k ][ i ] * static_cast< BinaryKnapsackBlock * >(
-						  v_Block[ i ] )->get_x( k );
+   if( auto MCFb = v_Block[ k2p( k ) ] )
+    static_cast< MCFBlock * >( MCFb )->get_x( fk.begin() ,
+					     Range( 0 , NArcs ) );
+   else  // a MCFBlock not constructed yet
+    std::fill( fk.begin(), fk.end() , 0 );
+   }
+  else
+   for( Index i = 0 ; i < NArcs ; ++i )
+    fk[ i ] = get_local_flow( k , i );
+  }
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+ /// get the value of all the flow variables of all commodities at once
+ /** Writes the flows of all the commodities (not the design variables) in
+  * the contiguous buffer x, that must have room for get_NComm() *
+  * get_NArcs() elements: if arcmjr == false, commodity by commodity (the
+  * flow of commodity k on arc i in x[ k * get_NArcs() + i ]), otherwise
+  * arc by arc (x[ i * get_NComm() + k ]). The values are the same as these
+  * of get_local_flow(), but each sub-Block is read only once (in the knapsack
+  * formulation, each BinaryKnapsackBlock, with the rescaling applied item
+  * by item), and the sub-Blocks are read in parallel if OpenMP is
+  * available. */
+
+ void get_all_flows( double * x , bool arcmjr = false ) const;
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+ /// get the flow of a given arc for a given commodity
+ /** Like get_local_flow( k , i ), but k is the index of the commodity in
+  * the whole instance [see deserialize_shard()], get_NCommGlobal() meaning
+  * the design variables; the flow of the commodities that are not in this
+  * shard is 0. For a MMCFBlock that is not a shard, the two coincide. */
+
+ double get_flow( Index k , Index i ) const {
+  const Index lk = global2local( k );
+  return( lk < Inf< Index >() ? get_local_flow( lk , i ) : 0 );
+  }
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+ /// get the value of all flow variables associated to a given commodity
+ /** Like get_local_flow( fk , k ), but k is the index of the commodity in
+  * the whole instance [see get_flow( k , i )]. */
+
+ void get_flow( std::vector< double > & fk , Index k ) const {
+  const Index lk = global2local( k );
+  if( lk < Inf< Index >() )
+   get_local_flow( fk , lk );
+  else
+   std::fill( fk.begin(), fk.end() , 0 );
   }
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
@@ -363,35 +1156,67 @@ class MMCFBlock : public Block
   if( ! ( AR & HasVar ) )
    return( nullptr );
 
-  if( ! ( AR & KnapsackRelaxation ) )
-   return( static_cast< MCFBlock * >( v_Block[ k ] )->i2p_x( i ) );
-  else
-   return( static_cast< BinaryKnapsackBlock * >(
-				      v_Block[ i ] )->get_Var( k ) );   
+  if( ( k < NComm ) && is_trivial( k ) )
+   return( nullptr );
+
+  if( AR & PathFormulation )  // there is no arc flow variable
+   return( nullptr );
+
+  if( ! ( AR & KnapsackRelaxation ) ) {
+   if( k == NComm )  // the design variables only exist in hybrid knapsacks
+    return( in_hybrid( i ) ? hyb_block( i )->get_Var( get_NFrmlK() )
+	                   : nullptr );
+   return( mcf_block( k2p( k ) )->i2p_x( i ) );
+   }
+  else {
+   const auto t = k == NComm ? ( has_design() ? KnpItm[ i ].size()
+				               : Inf< Index >() )
+	                     : knp_item( k2p( k ) , i );
+   return( t < Inf< Index >() ? static_cast< BinaryKnapsackBlock * >(
+					      v_Block[ i ] )->get_Var( t )
+	                      : nullptr );
+   }
   }
 
 /*--------------------------------------------------------------------------*/
  /// get the potential of flow balance constraint for node i for commodity k
+ /** Get the potential of the flow balance constraint of node i for
+  * commodity k. In the arc-path formulation there are no such constraints,
+  * and the potentials computed by the last call to price_paths() (or set
+  * by set_potential()) are returned. */
 
  double get_potential( Index k , Index i ) const {
-  if( ! ( AR & HasMutual ) )
+  if( ( ! ( AR & HasMutual ) ) || is_trivial( k ) )
    return( 0 );
 
+  if( AR & PathFormulation )
+   return( PathPi.empty() ? 0 : PathPi[ k2p( k ) ][ i ] );
+
   if( ! ( AR & KnapsackRelaxation ) )
-   return( static_cast< MCFBlock * >( v_Block[ k ] )->get_pi( i ) );
+   return( mcf_block( k2p( k ) )->get_pi( i ) );
   else
-   return( FCs[ k ][ i ].get_dual() );
+   return( FCs[ k2p( k ) ][ i ].get_dual() );
   }
 
 /*--------------------------------------------------------------------------*/
  /// get the dual value of the linking constraint for arc i
+ /** Get the dual value of the mutual capacity constraint of arc i, which is
+  * that of the corresponding row of MCs (0 if there is none) in the flow
+  * and arc-path formulations, and that of the knapsack constraint in the
+  * knapsack formulation; in the hybrid formulation it is either one,
+  * depending on how arc i is handled. */
 
  double get_dual( Index i ) const {
   if( ! ( AR & HasMutual ) )
    return( 0 );
 
-  if( ! ( AR & KnapsackRelaxation ) )
-   return( MCs[ i ].get_dual() );
+  if( in_hybrid( i ) )
+   return( hyb_block( i )->get_dual() );
+
+  if( ! ( AR & KnapsackRelaxation ) ) {
+   const auto r = mc_row( i );
+   return( r < MCs.size() ? MCs[ r ].get_dual() : 0 );
+   }
   else
    return( static_cast< BinaryKnapsackBlock * >( v_Block[ i ] )->get_dual()
 	   );   
@@ -402,11 +1227,17 @@ class MMCFBlock : public Block
  /// get the potential of flow balance constraint for node i for commodity k
 
  virtual void set_potential( CNumber pi,  Index k , Index i ) {
-  if( ( AR & HasMutual ) ){
+  if( ( AR & HasMutual ) && ( ! is_trivial( k ) ) ){
+   if( AR & PathFormulation ) {
+    if( PathPi.empty() )
+     PathPi.assign( get_NFrmlK() , Vec_CNumber( NNodes , 0 ) );
+    PathPi[ k2p( k ) ][ i ] = pi;
+    }
+   else
    if( ! ( AR & KnapsackRelaxation ) )
-    static_cast< MCFBlock * >( v_Block[ k ] )->set_pi( pi, i );
+    mcf_block( k2p( k ) )->set_pi( pi, i );
    else
-    FCs[ k ][ i ].set_dual(pi);
+    FCs[ k2p( k ) ][ i ].set_dual(pi);
    }
   } 
 
@@ -415,14 +1246,92 @@ class MMCFBlock : public Block
 
  virtual void set_dual( CNumber pi, Index i ) {
   if( ( AR & HasMutual ) ){
-   if( ! ( AR & KnapsackRelaxation ) )
-    MCs[ i ].set_dual(pi);
+   if( in_hybrid( i ) )
+    hyb_block( i )->set_dual( pi );
+   else
+   if( ! ( AR & KnapsackRelaxation ) ) {
+    const auto r = mc_row( i );
+    if( r < MCs.size() )
+     MCs[ r ].set_dual( pi );
+    }
    else
     static_cast< BinaryKnapsackBlock * >( v_Block[ i ] )->set_dual(pi);   
    }
   }
 
 
+/*--------------------------------------------------------------------------*/
+ /// get the potentials of all the nodes for commodity k
+ /** Writes in pi[ n ], n = 0, ..., get_NNodes() - 1, the same values as
+  * get_potential( k , n ), but reading the sub-Block (or the constraints)
+  * of commodity k only once. */
+
+ void get_potentials( double * pi , Index k ) const;
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+ /// set the potentials of all the nodes for commodity k
+ /** Same as set_potential( pi[ n ] , k , n ) for n = 0, ...,
+  * get_NNodes() - 1, but dispatching only once. */
+
+ void set_potentials( const double * pi , Index k );
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+ /// get the potentials of all the commodities as a K x n matrix
+ /** Writes in pi[ k * get_NNodes() + n ] the potential of node n for
+  * commodity k [see get_potentials()], for all commodities; the sub-Blocks
+  * are read in parallel if OpenMP is available. */
+
+ void get_all_potentials( double * pi ) const;
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+ /// set the potentials of all the commodities out of a K x n matrix
+ /** The converse of get_all_potentials(): the sub-Blocks are written in
+  * parallel if OpenMP is available (any MCFBlock not constructed yet [see
+  * LazySubBlocks] being constructed, sequentially, beforehand). */
+
+ void set_all_potentials( const double * pi );
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+ /// get the duals of the mutual capacity constraints of all the arcs
+ /** Writes in d[ i ], i = 0, ..., get_NArcs() - 1, the same values as
+  * get_dual( i ), in one pass over the constraints. */
+
+ void get_duals( double * d ) const;
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+ /// set the duals of the mutual capacity constraints of all the arcs
+ /** Same as set_dual( d[ i ] , i ) for all arcs i, in one pass over the
+  * constraints (the entries of the arcs having none being ignored). */
+
+ void set_duals( const double * d );
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+ /// the flows of this coarse instance mapped back to the fine one
+ /** Writes in x the flows of the instance this one has been coarsened from
+  * [see coarsen()], with the layout of get_all_flows() (hence x must have
+  * room for the number of commodities times the number of arcs of the fine
+  * instance), obtained from the current flows of this one: the flow of a
+  * coarse commodity on a coarse arc is split among the fine commodities in
+  * proportion to their (coarse) supply, and among the fine arcs in
+  * proportion to their mutual capacity. The flow on the arcs inside a
+  * cluster is 0, hence the result in general does not satisfy the flow
+  * conservation constraints within the clusters: it is meant as a warm
+  * start. The fine commodities are done in parallel if OpenMP is
+  * available. Throws std::logic_error if this is not a coarse instance. */
+
+ void prolong_flows( double * x ) const;
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+ /// the potentials of this coarse instance mapped back to the fine one
+ /** Writes in pi the potentials of the instance this one has been coarsened
+  * from [see coarsen()], with the layout of get_all_potentials() (hence to
+  * be loaded with set_all_potentials() on the fine MMCFBlock): each node
+  * gets the current potential of its cluster for the coarse commodity of
+  * its commodity, 0 for the commodities that have been dropped. Throws
+  * std::logic_error if this is not a coarse instance. */
+
+ void prolong_potentials( double * pi ) const;
+
 /*--------------------------------------------------------------------------*/
 
  void load_nc4( std::string & filename ) {
@@ -454,13 +1363,404 @@ void chg_fixed_costs( int seed , double lambda )
   }
  
  if( F.size() < get_NArcs() )
-  F.resize( get_NArcs() );
+  F.mut().resize( get_NArcs() );
 
  for( Index i = 0 ; i < get_NArcs() ; ++i )
-  F[ i ] = lambda * Cmean[ i ];
+  F.mut()[ i ] = lambda * Cmean[ i ];
  }
 
 
+/** @} ---------------------------------------------------------------------*/
+/*------------- METHODS FOR MODIFYING THE MMCFBlock ------------------------*/
+/*--------------------------------------------------------------------------*/
+/** @name Methods for modifying the MMCFBlock
+ *
+ * These methods change the data of the MMCFBlock without reloading it, and
+ * therefore without issuing the NBModification "nuclear option". If the
+ * abstract representation has been constructed it is updated in place, so
+ * that the attached Solver only see the (fine-grained) Modification of the
+ * affected Variable / Constraint / Objective / sub-Block and can reoptimize
+ * from their current state. issueMod decides if and how the "physical"
+ * MMCFBlockMod is issued, and issueAMod does the same for the "abstract"
+ * Modification. Note that any previous PreProcess() may no longer be valid
+ * after a change: the incremental PreProcess( c_Subset & , c_Subset & ,
+ * PPChanges * ) can be called on the changed arcs and commodities.
+ *  @{ */
+
+ /// set the Lagrangian costs of the MCFBlock in the flow formulation
+ /** In the flow formulation, sets the costs of the MCFBlock of each
+  * (formulated) commodity k to the Lagrangian reduced costs C[ k ][ i ] +
+  * lambda[ i ], i = 0, ..., get_NArcs() - 1, lambda[ i ] being the
+  * multiplier of the mutual capacity constraint of arc i (0 if the arc has
+  * none); lambda == nullptr means all-zero multipliers, i.e., it restores
+  * the original costs. This is what a Lagrangian decomposition dualizing
+  * the mutual capacity constraints does at each iteration: the data of the
+  * MMCFBlock (and therefore get_C()) is not changed, hence no MMCFBlockMod
+  * is issued, only the MCFBlock are changed (and they issue their own
+  * Modification according to issueMod and issueAMod). Only the arcs whose
+  * multiplier is different from that of the previous call are changed,
+  * with one cost change per MCFBlock; the MCFBlock are changed in parallel
+  * if OpenMP is available (sequentially in out-of-core mode [see
+  * set_out_of_core()]). The multipliers remain in force for the
+  * MCFBlock constructed later [see LazySubBlocks] and for the later
+  * changes of the costs [see chg_costs()], but are ignored by the other
+  * formulations, hence std::logic_error is thrown if one of them has
+  * already been constructed. */
+
+ void set_lagrangian_costs( const double * lambda ,
+			    ModParam issueMod = eModBlck ,
+			    ModParam issueAMod = eModBlck );
+
+/*--------------------------------------------------------------------------*/
+ /// evaluate the Lagrangian function relaxing the linking constraints
+ /** Evaluates, and returns, the Lagrangian function of the formulation
+  * relaxing its "linking" constraints with the multipliers mult, writing
+  * a subgradient in g:
+  *
+  * - in the flow formulation the relaxed constraints are MCs: mult[ i ]
+  *   (>= 0 for the value to be a lower bound) is the multiplier of the
+  *   mutual capacity constraint of arc i, ignored if the arc has none, the
+  *   costs of the MCFBlock are temporarily set as by set_lagrangian_costs()
+  *   (the previous multipliers, if any, being restored before returning or
+  *   throwing), and g[ i ] is the total flow on arc i minus UTot[ i ] for
+  *   the arcs with a mutual capacity constraint and 0 for the others, for
+  *   all the get_NArcs() arcs;
+  *
+  * - in the knapsack formulation the relaxed constraints are FCs:
+  *   mult[ k * get_NNodes() + n ] is the multiplier of the flow constraint
+  *   of commodity k at node n (ignored for the trivial commodities), taken
+  *   with the convention of the data that inflow minus outflow is
+  *   B[ k ][ n ] (as in evaluate_solution() and reduced_cost_fixing()),
+  *   so that the reduced cost of arc i = ( u , v ) is C[ k ][ i ] +
+  *   mult_u - mult_v and the constant term is the sum of mult times B; the
+  *   profits of the knapsacks are temporarily changed accordingly (except
+  *   for the items closed after the construction, which are fixed to 0),
+  *   and g[ k * get_NNodes() + n ] is the violation of the flow
+  *   constraint, i.e., B[ k ][ n ] plus outflow minus inflow (note that
+  *   the rows of FCs are rather written as outflow minus inflow equal to
+  *   B[ k ][ n ], hence their duals are not these multipliers); if the
+  *   knapsacks are continuous ones [see has_continuous_knapsacks()] they
+  *   are rather all solved by solve_continuous_knapsacks(), without
+  *   changing the profits and without using their Solver.
+  *
+  * All the sub-Blocks are solved in parallel (if OpenMP is available,
+  * except for the MCFBlock in out-of-core mode [see set_out_of_core()]),
+  * each by the first of its registered Solver, the solution being written
+  * in its Variable; issueMod and issueAMod are used for the changes of the
+  * costs of the sub-Blocks. Throws std::logic_error if the formulation
+  * (with its constraints) has not been constructed, if it is neither the
+  * flow nor the knapsack one, or if any sub-Block has no Solver or is not
+  * solved to optimality. */
+
+ double lagrangian_oracle( const double * mult , double * g ,
+			   ModParam issueMod = eModBlck ,
+			   ModParam issueAMod = eModBlck );
+
+/*--------------------------------------------------------------------------*/
+ /// true if the knapsacks of the formulation are continuous ones
+ /** Returns true if the knapsack formulation has been constructed and
+  * there are no fixed costs, so that (the Integrality of the
+  * MMCFBlockConfig being false) each knapsack is a continuous one that is
+  * solved by sorting its items [see solve_continuous_knapsacks()]. */
+
+ bool has_continuous_knapsacks( void ) const {
+  return( ( AR & HasVar ) && ( AR & KnapsackRelaxation ) &&
+	  ( ! ( AR & ( PathFormulation | HybridFormulation ) ) ) &&
+	  ( ! has_design() ) );
+  }
+
+/*--------------------------------------------------------------------------*/
+ /// solve all the continuous knapsacks at once
+ /** Solves all the get_NArcs() knapsacks of the formulation as continuous
+  * ones [see has_continuous_knapsacks(), which must be true or else
+  * std::logic_error is thrown], without going through their Solver: the
+  * items with negative cost per unit of weight are taken by increasing
+  * cost until the capacity UTot[ j ] is filled, the last one possibly
+  * fractionally. If pi is not nullptr, pi[ k * get_NNodes() + n ] is added
+  * to (subtracted from) the cost per unit of weight of the items of
+  * commodity k on the arcs leaving (entering) node n, as in the relaxation
+  * of the flow constraints [see lagrangian_oracle()], while the profits of
+  * the knapsacks are left untouched. The solution is written in the
+  * ColVariable of the knapsacks, so that it can be read with
+  * BinaryKnapsackBlock::get_x(), and the sum of the optimal values of the
+  * knapsacks is returned. The costs of the items are first gathered in a
+  * contiguous array per arc with one pass over the commodities (hence this
+  * streams in out-of-core mode [see set_out_of_core()]); then the
+  * knapsacks are solved in parallel if OpenMP is available, the reduced
+  * costs of the items of each arc being computed in a vectorized loop and
+  * then sorted, with no Modification issued. */
+
+ double solve_continuous_knapsacks( const double * pi = nullptr );
+
+/*--------------------------------------------------------------------------*/
+ /// lower bound and potentials out of the shortest path relaxation
+ /** Returns a lower bound on the optimal value of the MMCF, obtained by
+  * dropping the mutual capacity constraints, the individual capacities and
+  * the fixed costs (which are nonnegative): each commodity then is an
+  * uncapacitated min cost flow problem, whose optimal dual solution is
+  * bounded by the shortest path distances from its origins (the nodes with
+  * negative deficit, all at distance 0). This is exact for the single
+  * origin commodities, and a valid bound for the others; commodities with
+  * the same origins and costs share the same shortest path tree, and the
+  * trees are computed in parallel if OpenMP is available (sequentially in
+  * out-of-core mode [see set_out_of_core()]). The trivial commodities [see
+  * is_trivial()] contribute 0. The bound is Inf< double >() if some
+  * destination can not be reached from the origins of its commodity, and
+  * - Inf< double >() if a negative cost cycle exists for some commodity.
+  *
+  * If pi is not nullptr, pi[ k * get_NNodes() + n ] is set to the potential
+  * of node n for commodity k, with the same convention as price_paths(),
+  * i.e., minus the shortest path distance (0 if the node is unreachable,
+  * the commodity is trivial or has a negative cycle), so that it can be
+  * loaded into the formulation by set_all_potentials() as a warm start.
+  * This does not need the formulation to have been constructed. */
+
+ double shortest_path_bound( double * pi = nullptr );
+
+/*--------------------------------------------------------------------------*/
+ /// evaluate a solution: objective value and constraint violations
+ /** Evaluates the solution whose flows are in x, with the same layout as
+  * in get_all_flows() (the flow of commodity k on arc i in x[ k *
+  * get_NArcs() + i ]), or the current one of the formulation if x is
+  * nullptr, returning its objective value and the maximum and total
+  * violation of each family of constraints [see SolutionEval]. The flow
+  * conservation constraints are violated by | inflow - outflow - B[ k ][ n
+  * ] |, the flow bounds by the flow that is either negative or above U[ k
+  * ][ i ] (any flow on an arc closed for k being a violation, and not
+  * entering the objective), and the mutual capacities by the total flow
+  * above UTot[ i ]. If there are fixed costs, y[ i ] is the value of the
+  * design variable of arc i, which multiplies both U[ k ][ i ] and
+  * UTot[ i ]; if y is nullptr, the cheapest design supporting x is used,
+  * i.e., y[ i ] = 1 if and only if there is a positive flow on arc i (pass
+  * the values of get_local_flow( get_NComm() , i ) to check the design of the
+  * formulation). The topn arcs and nodes with largest (nonzero) violation
+  * are reported in TopArcs and TopNodes.
+  *
+  * The commodities are scanned in parallel if OpenMP is available
+  * (sequentially in out-of-core mode [see set_out_of_core()]), each in one
+  * contiguous pass over its flows, so that this can be called inside a
+  * heuristic loop. */
+
+ SolutionEval evaluate_solution( const double * x = nullptr ,
+				 const double * y = nullptr ,
+				 Index topn = 10 );
+
+/*--------------------------------------------------------------------------*/
+ /// slope scaling primal heuristic for the flow formulation
+ /** Runs (at most maxit iterations of) the slope scaling heuristic for the
+  * fixed charge MMCF, using the MCFBlock of the flow formulation (which
+  * must have been constructed, or else std::logic_error is thrown; any
+  * MCFBlock not constructed yet [see LazySubBlocks] is constructed first).
+  * At each iteration the cost of each arc i is increased for all the
+  * commodities [see set_lagrangian_costs()] by its current slope, that is
+  * F[ i ] divided by the total flow on i at the previous iteration
+  * (initially by UTot[ i ]), plus a penalty that grows with the violation
+  * of its mutual capacity at the previous iterations, since the MCFBlock
+  * are solved independently (in parallel, if OpenMP is available, each by
+  * the first of its registered Solver). The resulting flows are rounded to
+  * the design opening exactly the arcs with positive flow, and evaluated
+  * [see evaluate_solution()]; if all the violations are at most eps, they
+  * give a feasible solution. Without fixed costs only the penalties are
+  * used. The heuristic stops early if the flows of a feasible solution are
+  * the same as in the previous iteration.
+  *
+  * Returns the value of the best feasible solution found (Inf< double >()
+  * if none), whose flows are written in x (with the layout of
+  * get_all_flows()) and its design in y, if they are not nullptr. The costs
+  * of the MCFBlock are restored to what they were before the call, and
+  * issueMod and issueAMod are used for all the cost changes. Throws
+  * std::logic_error if any MCFBlock has no Solver or is not solved to
+  * optimality. */
+
+ double slope_scaling( Index maxit = 20 , double eps = 1e-6 ,
+		       double * x = nullptr , double * y = nullptr ,
+		       ModParam issueMod = eModBlck ,
+		       ModParam issueAMod = eModBlck );
+
+/*--------------------------------------------------------------------------*/
+ /// close the arcs that can not be in a better solution than ub
+ /** Reduced cost fixing of the design arcs. For any node multipliers pi
+  * (pi[ k * get_NNodes() + n ] being that of node n for commodity k, with
+  * the convention of lagrangian_oracle() that the reduced cost of arc i =
+  * ( u , v ) is C[ k ][ i ] + pi_u - pi_v), relaxing the flow conservation
+  * constraints gives the lower bound (that is, the value that
+  * lagrangian_oracle() returns with continuous knapsacks)
+  *
+  *   L = sum_i min( 0 , F[ i ] + v_i ) + sum_k pi^k B[ k ]
+  *
+  * where v_i is the optimal value of the continuous knapsack of arc i, in
+  * which commodity k has the reduced cost of i and takes at most
+  * min( U[ k ][ i ] , UTot[ i ] ) units of the capacity UTot[ i ] (the
+  * deficits B being inflow minus outflow). If there are fixed costs [see
+  * has_design()] and L - min( 0 , F[ i ] + v_i ) + F[ i ] + v_i, the
+  * bound with arc i forced open, is larger than the value ub of a known
+  * solution (up to a relative tolerance of 1e-9), arc i can not be used in
+  * any better one, and it is closed by setting its cost to
+  * Inf< CNumber >() for all the commodities [see chg_costs()], which
+  * updates (and shrinks) the formulation in place with issueMod and
+  * issueAMod; this is done with one call per commodity using any of the
+  * closed arcs, on the Range covering all of them. Without fixed costs no
+  * arc is closed, the bound with an arc forced open being L itself.
+  *
+  * If pi is nullptr the opposite of the current potentials are used [see
+  * get_all_potentials()], since these have the convention of MCFBlock
+  * (reduced cost C[ k ][ i ] - pi_u + pi_v); if lb is not nullptr, L is
+  * written there. The arcs are processed in blocks, the costs of each
+  * block being scanned commodity by commodity (hence this also works in
+  * out-of-core mode [see set_out_of_core()]) into arc-major buffers of at
+  * most about 2^20 elements, and then the arcs of the block are processed
+  * in parallel if OpenMP is available. Returns the arcs that have been
+  * closed, in increasing order. */
+
+ Subset reduced_cost_fixing( double ub , const double * pi = nullptr ,
+			     double * lb = nullptr ,
+			     ModParam issueMod = eModBlck ,
+			     ModParam issueAMod = eModBlck );
+
+/*--------------------------------------------------------------------------*/
+ /// change the costs of commodity k on the arcs in the Range rng
+ /** Change the costs of commodity k on the arcs in the Range rng (clipped
+  * to get_NArcs()), the new values being found in the interval of the same
+  * length starting from NCost. A cost becoming Inf< CNumber >() closes the
+  * arc for commodity k, a cost becoming finite again reopens it. In the
+  * flow and hybrid formulations the change is forwarded to the MCFBlock of
+  * k, in the knapsack formulation the profit of the corresponding items is
+  * changed, and in the arc-path formulation the Objective coefficient of
+  * all the paths of k that use any of the arcs is changed; in these two,
+  * the arcs of rng whose cost does not actually change are skipped. Since
+  * the knapsack formulation has no items for the arcs that a commodity can
+  * not use, opening one of them there throws std::logic_error, as does
+  * making a trivial commodity non-trivial after the formulation is
+  * constructed. */
+
+ void chg_costs( Index k , c_Vec_CNumber_it NCost ,
+		 Range rng = Range( 0 , Inf< Index >() ) ,
+		 ModParam issueMod = eModBlck , ModParam issueAMod = eModBlck );
+
+/*--------------------------------------------------------------------------*/
+ /// change the fixed costs of the arcs in the Range rng
+ /** Change the fixed costs F of the arcs in the Range rng (clipped to
+  * get_NArcs()), the new values being found in the interval of the same
+  * length starting from NFCost. The fixed costs are the profit of the
+  * design item of the knapsacks in the knapsack and hybrid formulations,
+  * which is changed accordingly; they do not appear in the flow and
+  * arc-path formulations. Turning a problem without fixed costs into one
+  * with them after the knapsack or hybrid formulation has been constructed
+  * throws std::logic_error, since there is no design item to change. */
+
+ void chg_fixed_costs( c_Vec_CNumber_it NFCost ,
+		       Range rng = Range( 0 , Inf< Index >() ) ,
+		       ModParam issueMod = eModBlck ,
+		       ModParam issueAMod = eModBlck );
+
+/*--------------------------------------------------------------------------*/
+ /// change the mutual capacities of the arcs in the Range rng
+ /** Change the mutual capacities UTot of the arcs in the Range rng (clipped
+  * to get_NArcs()), the new values being found in the interval of the same
+  * length starting from NUTot; Inf< FNumber >() means no mutual capacity
+  * constraint. In the flow, hybrid and arc-path formulations the RHS of the
+  * corresponding row of MCs is changed; in the knapsack formulation (and
+  * for the arcs handled by a knapsack in the hybrid one) the capacity of
+  * the knapsack, or the weight of the design item, is changed, together
+  * with the scale of the items that depended on the mutual capacity. If
+  * the mutual capacity constraint of an arc is not in the formulation
+  * (because PreProcess() found it redundant, or the mutual capacity was
+  * infinite) and the new value makes it binding, or if in the knapsack
+  * formulation the new value would let a commodity use an arc for which
+  * it has no item, std::logic_error is thrown; the whole range is checked
+  * before anything is changed, so that the block is then left as it was. */
+
+ void chg_mutual_capacity( c_Vec_FNumber_it NUTot ,
+			   Range rng = Range( 0 , Inf< Index >() ) ,
+			   ModParam issueMod = eModBlck ,
+			   ModParam issueAMod = eModBlck );
+
+/*--------------------------------------------------------------------------*/
+ /// change the individual capacities of commodity k on the arcs in rng
+ /** Change the individual capacities U[ k ] of the arcs in the Range rng
+  * (clipped to get_NArcs()), the new values being found in the interval of
+  * the same length starting from NU. In the flow and hybrid formulations
+  * the change is forwarded to the MCFBlock of k (and the scale of the
+  * items of k in the hybrid knapsacks is updated), in the knapsack
+  * formulation the scale, weight and profit of the items of k are
+  * changed, and in the arc-path formulation the RHS of the individual
+  * capacity constraints is. std::logic_error is thrown if the change
+  * requires something that is not in the formulation, i.e., a knapsack
+  * item for an arc that k could not use, or an individual capacity
+  * constraint in the arc-path formulation that was found not binding. */
+
+ void chg_commodity_capacity( Index k , c_Vec_FNumber_it NU ,
+			      Range rng = Range( 0 , Inf< Index >() ) ,
+			      ModParam issueMod = eModBlck ,
+			      ModParam issueAMod = eModBlck );
+
+/*--------------------------------------------------------------------------*/
+ /// change the deficits of commodity k on the nodes in the Range rng
+ /** Change the deficits of commodity k on the nodes in the Range rng
+  * (clipped to get_NNodes()), the new values being found in the interval
+  * of the same length starting from NDfct. In the flow and hybrid
+  * formulations the change is forwarded to the MCFBlock of k; in the
+  * knapsack formulation the RHS of the flow constraints is changed (and
+  * the scale of the items of k is updated if the bound on its flow is); in
+  * the arc-path formulation the RHS of the demand constraint is, which is
+  * only possible if origin and destination do not change (or the demand
+  * becomes 0) and no individual capacity constraint that was found not
+  * binding becomes binding: std::logic_error is thrown otherwise, and also
+  * if a trivial commodity is made non-trivial after the formulation is
+  * constructed. */
+
+ void chg_deficits( Index k , c_Vec_FNumber_it NDfct ,
+		    Range rng = Range( 0 , Inf< Index >() ) ,
+		    ModParam issueMod = eModBlck ,
+		    ModParam issueAMod = eModBlck );
+
+/*--------------------------------------------------------------------------*/
+ /// add a commodity, returning its name
+ /** Add a commodity with the given costs c and individual capacities u (of
+  * size get_NArcs()) and deficits b (of size get_NNodes()), with the same
+  * conventions as in load(), the data being moved into the MMCFBlock. The
+  * slot of a removed commodity [see remove_commodity()] is reused if there
+  * is one, so that the names of the other commodities never change;
+  * otherwise the new commodity is appended, and get_NComm() grows by one.
+  * The name of the new commodity is returned.
+  *
+  * If the formulation has been constructed:
+  *
+  * - in the flow formulation, the MCFBlock of a reused slot is changed, or
+  *   a new MCFBlock is constructed and its flow variables are added to the
+  *   mutual capacity constraints; no constraint is added, so the new flow
+  *   must not make binding that of an arc without a row in MCs (because
+  *   PreProcess() found it redundant);
+  *
+  * - in the knapsack formulation no item can be added, so the slot of a
+  *   removed commodity must be reused and the new commodity can only use
+  *   the arcs that have an item for that slot; the hybrid formulation has
+  *   the same restriction if some arcs are handled by knapsacks;
+  *
+  * - the arc-path formulation is not supported.
+  *
+  * A trivial commodity [see is_trivial()] is not formulated, unless it
+  * reuses the slot of a removed commodity that still is, in which case
+  * that slot is restored as for any other commodity.
+  *
+  * std::logic_error is thrown if any of the above fails, in which case the
+  * MMCFBlock is not changed. */
+
+ Index add_commodity( Vec_CNumber && c , Vec_FNumber && u ,
+		      Vec_FNumber && b , ModParam issueMod = eModBlck ,
+		      ModParam issueAMod = eModBlck );
+
+/*--------------------------------------------------------------------------*/
+ /// remove commodity k
+ /** Remove commodity k. Like arcs in MCFBlock, the removed commodity keeps
+  * its name (and its place in the formulation, if any): its deficits are
+  * set to 0, its costs to Inf< CNumber >() and all its flows are fixed to
+  * 0, and it is marked as removed [see is_removed()] so that its slot can
+  * be reused by add_commodity(). */
+
+ void remove_commodity( Index k , ModParam issueMod = eModBlck ,
+			ModParam issueAMod = eModBlck );
+
 /** @} ---------------------------------------------------------------------*/
 /*-------------------- PROTECTED PART OF THE CLASS -------------------------*/
 /*--------------------------------------------------------------------------*/
@@ -481,6 +1781,265 @@ void chg_fixed_costs( int seed , double lambda )
 
  void CmnIntlz( void );
 
+/*--------------------------------------------------------------------------*/
+ /// position of commodity k among the formulated ones
+
+ Index k2p( Index k ) const { return( PosK.empty() ? k : PosK[ k ] ); }
+
+/*--------------------------------------------------------------------------*/
+ /// name of the commodity in position h among the formulated ones
+
+ Index p2k( Index h ) const { return( PosK.empty() ? h : FrmlK[ h ] ); }
+
+/*--------------------------------------------------------------------------*/
+ /// index in MCs of the mutual capacity constraint of arc i
+ /** Returns the index in MCs of the mutual capacity constraint of arc i, or
+  * Inf< Index >() if there is none. */
+
+ Index mc_row( Index i ) const {
+  auto it = std::lower_bound( MCArc.begin() , MCArc.end() , i );
+  return( ( it != MCArc.end() ) && ( *it == i ) ?
+	  Index( std::distance( MCArc.begin() , it ) ) : Inf< Index >() );
+  }
+
+/*--------------------------------------------------------------------------*/
+ /// item of commodity in position h in the knapsack of arc i
+ /** Returns the index of the item of the (formulated) commodity in position
+  * h in the knapsack of arc i, or Inf< Index >() if there is none because
+  * commodity h can not use arc i. */
+
+ Index knp_item( Index h , Index i ) const {
+  const auto & itm = KnpItm[ i ];
+  auto it = std::lower_bound( itm.begin() , itm.end() , h );
+  return( ( it != itm.end() ) && ( *it == h ) ?
+	  Index( std::distance( itm.begin() , it ) ) : Inf< Index >() );
+  }
+
+/*--------------------------------------------------------------------------*/
+ /// computes ActiveK[ k ] out of C[ k ] and U[ k ]
+
+ void set_ActiveK( Index k );
+
+/*--------------------------------------------------------------------------*/
+ /// computes NamesK out of NCnst and ActiveK
+
+ void set_NamesK( void );
+
+/*--------------------------------------------------------------------------*/
+ /// tells if a commodity with costs c and deficits b is trivial
+
+ static bool trivial_data( const Vec_CNumber & c , const Vec_FNumber & b );
+
+/*--------------------------------------------------------------------------*/
+ /// bound on the flow of a commodity with costs c, capacities u, deficits b
+ /** Bound on the flow of a commodity with costs c, individual capacities u
+  * and deficits b (possibly empty) on any arc, used for the scales of the
+  * knapsack formulation when PreProcess() has not been called. */
+
+ FNumber knp_max_flow( const Vec_CNumber & c , const Vec_FNumber & u ,
+		       const Vec_FNumber & b ) const;
+
+/*--------------------------------------------------------------------------*/
+ /// take the commodity in position h out of its group in PathGrps
+
+ void path_ungroup( Index h );
+
+/*--------------------------------------------------------------------------*/
+ /// update the Objective of the arc-path formulation after C[ k ] changed
+ /** Update the Objective coefficients of the paths of the commodity in
+  * position h using arcs in rng after a change of its costs, whose old
+  * values are in OCost, fixing to 0 these using closed arcs (and unfixing
+  * these whose arcs have all been reopened), and take it out of its group
+  * in PathGrps. */
+
+ void chg_path_costs( Index h , Range rng , const Vec_CNumber & OCost ,
+		      ModParam issueAMod );
+
+/*--------------------------------------------------------------------------*/
+ /// scale of the item of the commodity in position h on arc j (knapsack)
+
+ FNumber knp_scale( Index h , Index j ) const {
+  return( std::min( { U[ p2k( h ) ][ j ] , UTot[ j ] , KnpMxF[ h ] } ) );
+  }
+
+/*--------------------------------------------------------------------------*/
+ /// change the scale of item t of the knapsack of arc j to s
+ /** Change the scale of item t of the knapsack of arc j to s, updating its
+  * weight and profit and its coefficients in the flow constraints. */
+
+ void knp_rescale( Index j , Index t , FNumber s , ModParam issueAMod );
+
+/*--------------------------------------------------------------------------*/
+ /// check that the knapsacks can represent new data of a commodity
+ /** Check that the knapsack formulation can represent the commodity in
+  * position h with costs c, individual capacities u and flow bound mf,
+  * i.e., that every arc it can use has an item with a finite scale;
+  * std::logic_error (prefixed by who) is thrown otherwise. */
+
+ void chk_knapsack_commodity( Index h , const Vec_CNumber & c ,
+			      const Vec_FNumber & u , FNumber mf ,
+			      const std::string & who ) const;
+
+/*--------------------------------------------------------------------------*/
+ /// set the flow bound of the commodity in position h to mf (knapsack)
+ /** Set KnpMxF[ h ] to mf, rescaling all the items of the commodity in
+  * position h whose scale changes as a consequence. */
+
+ void knp_set_max_flow( Index h , FNumber mf , ModParam issueAMod );
+
+/*--------------------------------------------------------------------------*/
+ /// gather the costs of the items of all the knapsacks in KnpCst
+ /** Fills KnpCst[ j ] with the costs of the items of the knapsack of arc j,
+  * contiguously, with one pass over the commodities (hence this streams in
+  * out-of-core mode [see set_out_of_core()]), so that the arc-wise loops
+  * then do not read C[] at all. */
+
+ void knp_gather_costs( void );
+
+/*--------------------------------------------------------------------------*/
+ /// update the scales of the knapsack of arc i in the hybrid formulation
+ /** Update the scale of the variables of the knapsack of arc i in the
+  * hybrid formulation (that of the commodity in position h only, if h <
+  * get_NFrmlK()), changing their weights and copy constraints. */
+
+ void hyb_rescale( Index i , Index h , ModParam issueAMod );
+
+/*--------------------------------------------------------------------------*/
+ /// throw if the formulation can not represent the current UTot[ i ]
+ /** Throws std::logic_error (whose message starts with who) if the
+  * constructed formulation can not represent the current value of UTot[ i
+  * ], i.e., if the flow of some item of arc i would become unbounded, or
+  * if arc i has no row in MCs and the constraint is no longer redundant.
+  * Nothing is changed, so that the caller can restore the data. */
+
+ void chk_mutual_capacity( Index i , const std::string & who ) const;
+
+ /// put the current UTot[ i ] in the formulation [see chk_mutual_capacity()]
+ void upd_mutual_capacity( Index i , ModParam issueAMod );
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+ /// throw if the formulation can not represent the current U[ k ][ i ]
+ /** As chk_mutual_capacity(), for the individual capacity of commodity k on
+  * arc i: it throws if the individual capacity constraint is no longer
+  * redundant and it is not in the arc-path formulation, or if the arc
+  * would be opened, or its flow would be unbounded, in the knapsack one. */
+
+ void chk_commodity_capacity( Index k , Index i , const std::string & who )
+  const;
+
+ /// put the current U[ k ] on the arcs in rng in the formulation
+ void upd_commodity_capacity( Index k , Range rng , ModParam issueMod ,
+			      ModParam issueAMod );
+
+/*--------------------------------------------------------------------------*/
+ /// construct the knapsacks of the knapsack formulation
+
+ void generate_knapsacks( void );
+
+/*--------------------------------------------------------------------------*/
+ /// construct the flow (and strong linking) constraints of the knapsack one
+
+ void generate_knapsack_constraints( void );
+
+/*--------------------------------------------------------------------------*/
+ /// tells if arc i is handled by a knapsack in the hybrid formulation
+
+ bool in_hybrid( Index i ) const {
+  return( ( ! HybPos.empty() ) && ( HybPos[ i ] < Inf< Index >() ) );
+  }
+
+/*--------------------------------------------------------------------------*/
+ /// the MCFBlock of the commodity in position h, constructing it if lazy
+
+ MCFBlock * mcf_block( Index h ) const {
+  if( ! v_Block[ h ] )  // lazily constructed: do it now, this does not
+   const_cast< MMCFBlock * >( this )->generate_sub_Block( h );  // change
+  return( static_cast< MCFBlock * >( v_Block[ h ] ) );   // the instance
+  }
+
+/*--------------------------------------------------------------------------*/
+ /// the knapsack of arc i in the hybrid formulation
+
+ BinaryKnapsackBlock * hyb_block( Index i ) const {
+  return( static_cast< BinaryKnapsackBlock * >(
+				  v_Block[ get_NFrmlK() + HybPos[ i ] ] ) );
+  }
+
+/*--------------------------------------------------------------------------*/
+ /// scale of the knapsack variable of commodity k on arc i (hybrid)
+
+ FNumber hyb_scale( Index k , Index i ) const {
+  return( std::min( U[ k ][ i ] , UTot[ i ] ) );
+  }
+
+/*--------------------------------------------------------------------------*/
+ /// true if there are (nonzero) fixed costs, i.e., design variables
+
+ bool has_design( void ) const {
+  return( ( F.size() == NArcs ) &&
+	  std::any_of( F.begin() , F.end() ,
+		       []( CNumber f ) { return( f > 0 ); } ) );
+  }
+
+/*--------------------------------------------------------------------------*/
+ /// construct the knapsacks of the hybrid formulation for the arcs in hyb
+
+ void generate_hybrid_knapsacks( Subset && hyb );
+
+/*--------------------------------------------------------------------------*/
+ /// construct the copy (and strong linking) constraints of the hybrid one
+
+ void generate_hybrid_constraints( void );
+
+/*--------------------------------------------------------------------------*/
+ /// construct the MCFBlock of commodity k, with the current abstract repr.
+
+ MCFBlock * new_mcf_block( Index k );
+
+ /// the costs of the MCFBlock of k, C[ k ] plus the multipliers in LgrLmb
+ Vec_CNumber mcf_costs( Index k ) const;
+
+/*--------------------------------------------------------------------------*/
+ /// shortest path tree out of node org with arc lengths len
+ /** Computes the shortest path tree out of node org (0-based) with arc
+  * lengths len[], un-existent arcs having length Inf< CNumber >(). This is
+  * a label-correcting algorithm (with the "small label first" rule), hence
+  * lengths can be negative. On output dist[ v ] is the distance of node v
+  * (Inf< CNumber >() if unreachable) and pred[ v ] the arc entering v in the
+  * tree (Inf< Index >() if none). Returns false if a negative cycle has been
+  * found, in which case the output is meaningless. */
+
+ bool sp_tree( Index org , const Vec_CNumber & len , Vec_CNumber & dist ,
+	       Subset & pred ) const {
+  return( sp_tree( Subset( 1 , org ) , len , dist , pred ) );
+  }
+
+ /// as above, but out of all the nodes in orgs, all with distance 0
+ bool sp_tree( c_Subset & orgs , const Vec_CNumber & len ,
+	       Vec_CNumber & dist , Subset & pred ) const;
+
+/*--------------------------------------------------------------------------*/
+ // pieces of the arc-path formulation
+
+ /// flow on arc i of the formulated commodity h in the arc-path formulation
+ double path_flow( Index h , Index i ) const;
+
+ /// adds the flows of the formulated commodity h in the arc-path formulation
+ void path_flow( Index h , std::vector< double > & fk ) const;
+
+ /// adds a path for the formulated commodity h in the arc-path formulation
+ /** Adds the path P (a sequence of arc names) for the formulated commodity
+  * h. If the constraints (the Objective) have already been constructed the
+  * new ColVariable is added to them, and the Modification are issued as
+  * dictated by issueMod. */
+ void add_path( Index h , Subset && P , ModParam issueMod = eModBlck );
+
+ /// construct the arc-path formulation
+ void generate_path_variables( void );
+
+ /// construct the constraints of the arc-path formulation
+ void generate_path_constraints( void );
+
 /* @} ----------------------------------------------------------------------*/
 /*--------------------------- PROTECTED FIELDS  ----------------------------*/
 /*--------------------------------------------------------------------------*/
@@ -516,6 +2075,18 @@ void chg_fixed_costs( int seed , double lambda )
 
  static constexpr unsigned char slc = 8;
  ///< fourth bit of AR == 1: true if we use the strong forcing constraints
+
+ static constexpr unsigned char PathFormulation = 16;
+ ///< fifth bit of AR == 1 if the arc-path formulation is used
+
+ static constexpr unsigned char HybridFormulation = 32;
+ ///< sixth bit of AR == 1 if the hybrid flow/knapsack formulation is used
+
+ static constexpr unsigned char LazySubBlocks = 64;
+ ///< seventh bit of AR == 1 if the MCFBlock are constructed lazily
+
+ static constexpr unsigned char HasObjective = 128;
+ ///< eighth bit of AR == 1 if the Objective has been constructed
  
  Index NXtrV;          ///< Number of "extra" variables
  Index NXtrC;          ///< Number of "extra" constraints
@@ -529,28 +2100,61 @@ void chg_fixed_costs( int seed , double lambda )
  Index NComm;          ///< Number of commodities
  Index NCnst;          ///< Number of arcs with mutual capacity constraints
 
- CMultiVector C;       ///< Matrix of the arc costs
- FMultiVector U;       ///< Matrix of the arc upper capacities
- FMultiVector B;       ///< Matrix of the node deficits
+ bool PPDone;          ///< true if PreProcess() has been called
+ FNumber PPIncUk;      ///< IncUk parameter of the last PreProcess()
+ FNumber PPDecUk;      ///< DecUk parameter of the last PreProcess()
+ FNumber PPIncUjk;     ///< IncUjk parameter of the last PreProcess()
+ FNumber PPDecUjk;     ///< DecUjk parameter of the last PreProcess()
+ FNumber PPChgDfct;    ///< ChgDfct parameter of the last PreProcess()
+ CNumber PPDecCsts;    ///< DecCsts parameter of the last PreProcess()
+
+ Vec_FNumber MaxFlwK;  ///< rough estimate of the max. flow of each commodity
+ FNumber MaxFlw;       ///< sum of MaxFlwK[]
+ Vec_FNumber UTotOrg;  ///< mutual capacities before PreProcess() squeezing
+
+ std::vector< std::vector< std::pair< Index , FNumber > > > USqzd;
+ /**< USqzd[ k ] contains the pairs ( arc , original capacity ), ordered by
+  * arc name, of the individual capacities of commodity k that have been
+  * squeezed by PreProcess() */
+
+ // the instance data is shared with the clones until changed [see clone()]
+
+ std::vector< SharedVector< CNumber > > C;  ///< Matrix of the arc costs
+ std::vector< SharedVector< FNumber > > U;  ///< Matrix of the arc capacities
+ std::vector< SharedVector< FNumber > > B;  ///< Matrix of the node deficits
  FMultiVector I;       ///< Matrix of the variables integrality constraints
 
- Vec_FNumber UTot;     ///< Vector of mutual capacities
+ SharedVector< FNumber > UTot;  ///< Vector of mutual capacities
  
- Vec_CNumber F;        ///< Vector of fixed costs
+ SharedVector< CNumber > F;     ///< Vector of fixed costs
 
- Subset Startn;        ///< Topology of the graph: starting nodes
- Subset Endn;          ///< Topology of the graph: ending nodes
+ SharedVector< Index > Startn;  ///< Topology of the graph: starting nodes
+ SharedVector< Index > Endn;    ///< Topology of the graph: ending nodes
+
+ Subset FSBeg;         /**< forward star: the arcs leaving node v (0-based)
+			* are FSArc[ FSBeg[ v ] ] ... FSArc[ FSBeg[ v + 1 ] - 1 ]
+			*/
+ Subset FSArc;         ///< forward star: the arcs, ordered by tail node
 
  Index StrtNme;        ///< The "name" of the first node
  Subset NamesK;        /**< The dual multipliers relative to commodity K
 			* start with NamesK[ k ] and end with NamesK[ k + 1 ]
 			*/
- Subset Active;        /**< Set of the arcs for which a mutual capacity
-			* constraint is defined */
- MultiSubset ActiveK;  ///< Like Active for individual capacities
+ SharedVector< Index > Active;  /**< Set of the arcs for which a mutual
+				 * capacity constraint is defined */
+ std::vector< SharedVector< Index > > ActiveK;
+ ///< Like Active for individual capacities
  bool DrctdPrb;        ///< true if the problem is directed
  std::vector<MCFType> PT;  ///< type of flow subproblem
 
+ Subset FrmlK;         /**< The non-trivial commodities, i.e., those that are
+			* actually formulated, in increasing order; if PosK
+			* is empty it is empty too, meaning "all of them",
+			* otherwise it is empty only if all are trivial */
+ Subset PosK;          /**< PosK[ k ] is the position of commodity k in
+			* FrmlK, Inf< Index >() if k is trivial: empty means
+			* "the identity" */
+
  Vec_Bool CIsCpy;     ///< true for each row of C[] that is a copy of another
  Vec_Bool UIsCpy;     ///< true for each row of U[] that is a copy of another
  Vec_Bool BIsCpy;     ///< true for each row of B[] that is a copy of another
@@ -559,6 +2163,84 @@ void chg_fixed_costs( int seed , double lambda )
  boost::multi_array< FRowConstraint , 2 > FCs;  ///< the static flow constrs
  boost::multi_array< FRowConstraint , 2 > SLCs;
  ///< the static strong forcing constrs
+
+ // the arc-path formulation- - - - - - - - - - - - - - - - - - - - - - - - -
+ // all the vectors are indexed over the formulated commodities
+
+ Subset PathOrg;       ///< origin (0-based) of each commodity
+ Subset PathDst;       ///< destination (0-based) of each commodity
+ Vec_FNumber PathDmd;  ///< demand of each commodity
+
+ std::vector< std::list< ColVariable > > PathVars;
+ ///< the (dynamic) path flow variables of each commodity
+ std::vector< std::list< Subset > > PathArcs;
+ ///< the arcs of each path, in the same order as PathVars
+ std::vector< ColVariable > PathSlk;
+ ///< the (static) artificial variables: the unrouted demand
+ Vec_CNumber PathBigM; ///< the cost of the artificial variables
+
+ std::vector< FRowConstraint > PathDCs;  ///< the demand constraints
+ std::vector< FRowConstraint > PathICs;  ///< the individual capacity constrs
+ Subset PathICBeg;     /**< the individual capacity constraints of commodity
+			* h are PathICs[ PathICBeg[ h ] ] ...
+			* PathICs[ PathICBeg[ h + 1 ] - 1 ] */
+ Subset PathICArc;     ///< the arc of each individual capacity constraint
+
+ std::vector< Subset > PathGrps;  ///< commodities sharing the same SP tree
+ CMultiVector PathPi;  ///< node potentials of each commodity
+
+ FRealObjective PathObj;  ///< the Objective of the arc-path formulation
+
+ // the knapsack formulation- - - - - - - - - - - - - - - - - - - - - - - - -
+
+ std::vector< Subset > KnpItm;
+ /**< KnpItm[ j ][ t ] is the (position of the) commodity of item t of the
+  * knapsack of arc j, in increasing order; the commodities that can not use
+  * arc j have no item, and the design item (if any) is the last one */
+
+ std::vector< Vec_FNumber > KnpScl;
+ ///< KnpScl[ j ][ t ] is the scale s^k_j of item t of the knapsack of arc j
+
+ Vec_FNumber KnpMxF;   ///< the bound on the flow of each commodity used
+
+ std::vector< Vec_CNumber > KnpCst;
+ /**< KnpCst[ j ][ t ] is the cost C[ k ][ j ] of the commodity k of item t
+  * of the knapsack of arc j, as gathered by the last knp_gather_costs() */
+
+ // the hybrid formulation- - - - - - - - - - - - - - - - - - - - - - - - - -
+
+ Subset HybArcs;       ///< the (ordered) arcs handled by a knapsack
+ Subset HybPos;        /**< HybPos[ i ] is the position of arc i in HybArcs,
+			* Inf< Index >() if none: empty if not hybrid */
+ boost::multi_array< FRowConstraint , 2 > HCs;
+ ///< the copy constraints, HCs[ h ][ r ] for commodity h and HybArcs[ r ]
+
+ Subset MCArc;         ///< the arc of each row of MCs
+
+ Vec_Bool RmvdK;       ///< true for the removed commodities: empty if none
+
+ Vec_CNumber LgrLmb;   ///< the Lagrangian multipliers: empty if none
+
+ Subset SubNode;       ///< original node of each node: empty if identity
+ Subset SubArc;        ///< original arc of each arc: empty if identity
+ Subset SubComm;       ///< original commodity of each one: empty if identity
+
+ Subset CrsNode;       ///< coarse node of each fine node: empty if not coarse
+ Subset CrsArc;        ///< coarse arc of each fine arc, Inf if none
+ Subset CrsComm;       ///< coarse commodity of each fine one, Inf if none
+ Vec_FNumber CrsArcW;  ///< share of the flow of its coarse arc of each arc
+ Vec_FNumber CrsCommW; ///< share of the flow of its coarse comm. of each one
+
+ Index FirstK;         ///< index in the whole instance of commodity 0
+ Index NCommGlb;       ///< commodities of the whole instance, 0 if not shard
+
+ std::string OOCFile;  ///< file of the out-of-core mode, empty if none
+ Index OOCMaxRes;      ///< max. number of resident commodities out-of-core
+ std::shared_ptr< char > OOCMap;  ///< the mapped file, if any
+ Index OOCRows;        ///< number of commodities in the mapped file
+ std::list< Index > OOCLRU;  ///< resident commodities, most recent first
+ std::vector< std::list< Index >::iterator > OOCPos;
+ ///< position of each commodity in OOCLRU, OOCLRU.end() if none
  
  int f_sense = Objective::eMin;
 
@@ -573,6 +2255,99 @@ void chg_fixed_costs( int seed , double lambda )
 /*--------------------------------------------------------------------------*/
 
  void guts_of_destructor( void );
+
+/*--------------------------------------------------------------------------*/
+ /** Constructs FrmlK and PosK by finding the "trivial" commodities [see
+  * is_trivial()]. Does nothing if the abstract representation has already
+  * been constructed, since this would change the meaning of v_Block. */
+
+ void find_trivial_commodities( void );
+
+/*--------------------------------------------------------------------------*/
+ // pieces of PreProcess()
+
+ /// possible outcomes of pp_individual()
+ enum PPOutcome { kPPNonExistent = 0 , kPPRedundant , kPPActive };
+
+ /// rough estimate of the max. flow of commodity k on any arc
+ FNumber pp_max_flow( Index k ) const;
+
+ /// upper bound on the flow of commodity k on arc i (if PPIncUjk < Inf)
+ FNumber pp_flow_bound( Index k , Index i ) const;
+
+ /// decides if the mutual capacity constraint of arc i is active
+ /** Decides if the mutual capacity constraint of arc i is active, squeezing
+  * UTot[ i ] if it is not; if arc i is declared un-existent, the pairs
+  * ( k , i ) are added to *cls (if cls is not nullptr). If UMx is not
+  * nullptr, (*UMx)[ i ] is the sum over all k of pp_flow_bound( k , i ),
+  * which is otherwise computed here (if needed) looking at all the
+  * commodities. */
+ bool pp_mutual( Index i ,
+		 std::vector< std::pair< Index , Index > > * cls = nullptr ,
+		 const Vec_FNumber * UMx = nullptr );
+
+ /// decides about the individual capacity constraint of commodity k on arc i
+ /** Returns one of PPOutcome, squeezing U[ k ][ i ] if the constraint is
+  * redundant; Ai tells if the mutual capacity constraint of arc i is
+  * active. If the arc is declared un-existent, ( k , i ) is added to *cls
+  * (if cls is not nullptr). */
+ int pp_individual( Index k , Index i , bool Ai ,
+		    std::vector< std::pair< Index , Index > > * cls = nullptr );
+
+ /// sets U[ k ][ i ] to Uki recording the original value in USqzd[ k ]
+ void squeeze_U( Index k , Index i , FNumber Uki );
+
+ /// individual capacity of commodity k on arc i before any squeezing
+ FNumber orig_U( Index k , Index i ) const;
+
+/*--------------------------------------------------------------------------*/
+ // pieces of (de)serialize() and of the sharded files
+
+ /// position of x in the ordered sub, x itself if sub is empty, else Inf
+ static Index sub_index( const Subset & sub , Index x ) {
+  if( sub.empty() )
+   return( x );
+  auto it = std::lower_bound( sub.begin() , sub.end() , x );
+  return( ( it != sub.end() ) && ( *it == x ) ? Index( it - sub.begin() )
+	                                      : Inf< Index >() );
+  }
+
+ /// local index of the commodity gk of the whole instance, Inf if none
+ Index global2local( Index gk ) const {
+  if( gk == get_NCommGlobal() )
+   return( NComm );
+  return( ( gk >= FirstK ) && ( gk - FirstK < NComm ) ? gk - FirstK
+	                                              : Inf< Index >() );
+  }
+
+ /// reads NNodes, NArcs, NComm, Startn, Endn, UTot and F from group
+ void read_topology( const netCDF::NcGroup & group );
+
+ /// reads the NComm rows of U, B and C from group
+ void read_rows( const netCDF::NcGroup & group );
+
+ /// writes Startn, Endn, UTot and F into group, na being the NArcs dim
+ void write_arcs( netCDF::NcGroup & group , const netCDF::NcDim & na ) const;
+
+ /// writes the rows of U, B and C of the commodities in comms into group
+ /** Writes the rows of U, B and C of the commodities in comms into group
+  * one commodity at a time, only leaving in memory the rows that already
+  * were (which matters in out-of-core mode [see set_out_of_core()]). */
+ void write_rows( netCDF::NcGroup & group , Range comms ,
+		  const netCDF::NcDim & nc , const netCDF::NcDim & na ,
+		  const netCDF::NcDim & nn ) const;
+
+/*--------------------------------------------------------------------------*/
+ // pieces of the out-of-core mode [see set_out_of_core()]
+
+ /// creates and maps OOCFile, storing there the rows currently in memory
+ void ooc_open( void );
+
+ /// writes the changed rows of commodity k to the mapped file
+ void ooc_store( Index k );
+
+ /// marks commodity k as the most recently used, dropping the oldest ones
+ void ooc_touch( Index k );
  
 /*--------------------------------------------------------------------------*/
 /*---------------------------- PRIVATE FIELDS ------------------------------*/
@@ -584,6 +2359,104 @@ void chg_fixed_costs( int seed , double lambda )
 
  };  // end( class( MMCFBlock ) )
 
+/*--------------------------------------------------------------------------*/
+/*------------------------ CLASS MMCFBlockMod ------------------------------*/
+/*--------------------------------------------------------------------------*/
+/// class to describe the "physical" Modification specific to a MMCFBlock
+/** Derived class from Modification to describe the "physical" Modification
+ * specific to a MMCFBlock, i.e., changes of its data that are done in place
+ * rather than by reloading it (which issues a NBModification). */
+
+class MMCFBlockMod : public Modification
+{
+ public:
+
+ /// public enum for the types of MMCFBlockMod
+ enum MMCFB_mod_type {
+  eChgCost = 0 ,  ///< change the costs of a commodity
+  eChgFCost ,     ///< change the fixed costs
+  eChgUTot ,      ///< change the mutual capacities
+  eChgCap ,       ///< change the individual capacities of a commodity
+  eChgDfct ,      ///< change the deficits of a commodity
+  eAddComm ,      ///< add a commodity
+  eRmvComm        ///< remove a commodity
+  };
+
+ /// constructor: takes the MMCFBlock and the type
+ MMCFBlockMod( MMCFBlock * fblock , int type )
+  : f_Block( fblock ) , f_type( type ) {}
+
+ virtual ~MMCFBlockMod() {}  ///< destructor, does nothing
+
+ /// returns the Block to which the Modification refers
+ Block * get_Block( void ) const override { return( f_Block ); }
+
+ /// accessor to the type of modification
+ int type( void ) const { return( f_type ); }
+
+ protected:
+
+ /// prints the MMCFBlockMod
+ void print( std::ostream & output ) const override {
+  output << "MMCFBlockMod[" << this << "]: ";
+  switch( f_type ) {
+   case( eChgCost ): output << "change costs"; break;
+   case( eChgFCost ): output << "change fixed costs"; break;
+   case( eChgUTot ): output << "change mutual capacities"; break;
+   case( eChgCap ): output << "change individual capacities"; break;
+   case( eChgDfct ): output << "change deficits"; break;
+   case( eAddComm ): output << "add commodity"; break;
+   case( eRmvComm ): output << "remove commodity"; break;
+   default: output << "unknown";
+   }
+  }
+
+ MMCFBlock * f_Block;  ///< pointer to the MMCFBlock
+ int f_type;           ///< type of modification
+
+ };  // end( class( MMCFBlockMod ) )
+
+/*--------------------------------------------------------------------------*/
+/*--------------------- CLASS MMCFBlockRngdMod -----------------------------*/
+/*--------------------------------------------------------------------------*/
+/// class to describe "ranged" Modification specific to a MMCFBlock
+/** Derived class from MMCFBlockMod to describe a Modification of the data of
+ * a MMCFBlock that concerns a Range of arcs, possibly for one commodity
+ * only: the commodity is Inf< Index >() for changes that concern all of
+ * them (such as these of the fixed costs). */
+
+class MMCFBlockRngdMod : public MMCFBlockMod
+{
+ public:
+
+ /// constructor: takes the MMCFBlock, the type, the commodity and the range
+ MMCFBlockRngdMod( MMCFBlock * fblock , int type , Block::Index k ,
+		   Block::Range rng )
+  : MMCFBlockMod( fblock , type ) , f_k( k ) , f_rng( rng ) {}
+
+ virtual ~MMCFBlockRngdMod() {}  ///< destructor, does nothing
+
+ /// accessor to the commodity
+ Block::Index comm( void ) const { return( f_k ); }
+
+ /// accessor to the range
+ Block::c_Range & rng( void ) const { return( f_rng ); }
+
+ protected:
+
+ /// prints the MMCFBlockRngdMod
+ void print( std::ostream & output ) const override {
+  MMCFBlockMod::print( output );
+  if( f_k < Inf< Block::Index >() )
+   output << " of commodity " << f_k;
+  output << "[ " << f_rng.first << ", " << f_rng.second << " )";
+  }
+
+ Block::Index f_k;   ///< the commodity
+ Block::Range f_rng;  ///< the range
+
+ };  // end( class( MMCFBlockRngdMod ) )
+
 /*--------------------------------------------------------------------------*/
 
 /*@}  end( group( MMCFBlock_CLASSES ) ) -----------------------------------*/
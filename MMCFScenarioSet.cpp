@@ -0,0 +1,478 @@
+/*--------------------------------------------------------------------------*/
+/*------------------------ File MMCFScenarioSet.cpp ------------------------*/
+/*--------------------------------------------------------------------------*/
+/** @file
+ * Implementation of the MMCFScenarioSet class.
+ *
+ * \author Antonio Frangioni \n
+ *         Dipartimento di Informatica \n
+ *         Universita' di Pisa \n
+ *
+ * \author Enrico Gorgone \n
+ *         Dipartimento di Informatica \n
+ *         Universita' di Pisa \n
+ *
+ * \author Francesco Demelas \n
+ *         Laboratoire d'Informatique de Paris Nord \n
+ *         Universite' Sorbonne Paris Nord \n
+ *
+ * Copyright &copy by Antonio Frangioni, Enrico Gorgone, Francesco Demelas
+ */
+/*--------------------------------------------------------------------------*/
+/*---------------------------- IMPLEMENTATION ------------------------------*/
+/*--------------------------------------------------------------------------*/
+
+/*--------------------------------------------------------------------------*/
+/*------------------------------ INCLUDES ----------------------------------*/
+/*--------------------------------------------------------------------------*/
+
+#include "MMCFScenarioSet.h"
+
+#include <algorithm>
+
+/*--------------------------------------------------------------------------*/
+/*------------------------- NAMESPACE AND USING ----------------------------*/
+/*--------------------------------------------------------------------------*/
+
+using namespace SMSpp_di_unipi_it;
+
+/*--------------------------------------------------------------------------*/
+/*--------------------------------- TYPES ----------------------------------*/
+/*--------------------------------------------------------------------------*/
+
+using Index = Block::Index;
+
+/*--------------------------------------------------------------------------*/
+/*------------------- METHODS FOR BUILDING THE SET -------------------------*/
+/*--------------------------------------------------------------------------*/
+
+void MMCFScenarioSet::set_base( MMCFBlock * base )
+{
+ if( base == f_base )
+  return;
+
+ delete f_base;
+ f_base = base;
+
+ BDltBeg.assign( 1 , 0 );
+ BDltK.clear();
+ BDltN.clear();
+ BDltV.clear();
+
+ UDltBeg.assign( 1 , 0 );
+ UDltA.clear();
+ UDltV.clear();
+
+ }  // end( MMCFScenarioSet::set_base )
+
+/*--------------------------------------------------------------------------*/
+
+Index MMCFScenarioSet::add_scenario( std::vector< BDelta > && db ,
+				     std::vector< UDelta > && du )
+{
+ if( ! f_base )
+  throw( std::logic_error( "MMCFScenarioSet::add_scenario: no base" ) );
+
+ const Index nn = f_base->get_NNodes();
+ const Index na = f_base->get_NArcs();
+ const Index nc = f_base->get_NComm();
+
+ // deficits: sort by ( k , n ), the last given winning - - - - - - - - - - -
+
+ for( const auto & d : db )
+  if( ( d.k >= nc ) || ( d.n >= nn ) )
+   throw( std::invalid_argument(
+		      "MMCFScenarioSet::add_scenario: invalid deficit" ) );
+
+ std::stable_sort( db.begin() , db.end() ,
+		   []( const BDelta & a , const BDelta & b ) {
+		    return( ( a.k < b.k ) || ( ( a.k == b.k ) && ( a.n < b.n ) ) );
+		    } );
+
+ for( auto it = db.begin() ; it != db.end() ; ++it ) {
+  auto nx = std::next( it );
+  if( ( nx != db.end() ) && ( nx->k == it->k ) && ( nx->n == it->n ) )
+   continue;
+  if( it->b == f_base->get_B( it->k )[ it->n ] )
+   continue;
+  BDltK.push_back( it->k );
+  BDltN.push_back( it->n );
+  BDltV.push_back( it->b );
+  }
+
+ BDltBeg.push_back( BDltK.size() );
+
+ // mutual capacities: the same - - - - - - - - - - - - - - - - - - - - - - -
+
+ for( const auto & d : du )
+  if( d.a >= na )
+   throw( std::invalid_argument(
+	      "MMCFScenarioSet::add_scenario: invalid mutual capacity" ) );
+
+ std::stable_sort( du.begin() , du.end() ,
+		   []( const UDelta & a , const UDelta & b ) {
+		    return( a.a < b.a );
+		    } );
+
+ for( auto it = du.begin() ; it != du.end() ; ++it ) {
+  auto nx = std::next( it );
+  if( ( nx != du.end() ) && ( nx->a == it->a ) )
+   continue;
+  if( it->u == f_base->get_UTot()[ it->a ] )
+   continue;
+  UDltA.push_back( it->a );
+  UDltV.push_back( it->u );
+  }
+
+ UDltBeg.push_back( UDltA.size() );
+
+ return( get_NScenarios() - 1 );
+
+ }  // end( MMCFScenarioSet::add_scenario( deltas ) )
+
+/*--------------------------------------------------------------------------*/
+
+Index MMCFScenarioSet::add_scenario( const MMCFBlock & blk )
+{
+ if( ! f_base )
+  throw( std::logic_error( "MMCFScenarioSet::add_scenario: no base" ) );
+
+ const Index nn = f_base->get_NNodes();
+ const Index na = f_base->get_NArcs();
+ const Index nc = f_base->get_NComm();
+
+ if( ( blk.get_NNodes() != nn ) || ( blk.get_NArcs() != na ) ||
+     ( blk.get_NComm() != nc ) )
+  throw( std::invalid_argument(
+		  "MMCFScenarioSet::add_scenario: wrong MMCFBlock size" ) );
+
+ std::vector< BDelta > db;
+ for( Index k = 0 ; k < nc ; ++k ) {
+  const auto & Bb = f_base->get_B( k );
+  const auto & Bk = blk.get_B( k );
+  for( Index n = 0 ; n < nn ; ++n )
+   if( Bk[ n ] != Bb[ n ] )
+    db.push_back( { k , n , Bk[ n ] } );
+  }
+
+ std::vector< UDelta > du;
+ const auto & Ub = f_base->get_UTot();
+ const auto & Uk = blk.get_UTot();
+ for( Index a = 0 ; a < na ; ++a )
+  if( Uk[ a ] != Ub[ a ] )
+   du.push_back( { a , Uk[ a ] } );
+
+ return( add_scenario( std::move( db ) , std::move( du ) ) );
+
+ }  // end( MMCFScenarioSet::add_scenario( MMCFBlock ) )
+
+/*--------------------------------------------------------------------------*/
+/*-------------------- METHODS FOR READING THE SET -------------------------*/
+/*--------------------------------------------------------------------------*/
+
+FNumber MMCFScenarioSet::get_B( Index s , Index k , Index n ) const
+{
+ Index p = find_B( s , k , n );
+ return( p < Inf< Index >() ? BDltV[ p ] : f_base->get_B( k )[ n ] );
+ }
+
+/*--------------------------------------------------------------------------*/
+
+FNumber MMCFScenarioSet::get_UTot( Index s , Index a ) const
+{
+ Index p = find_U( s , a );
+ return( p < Inf< Index >() ? UDltV[ p ] : f_base->get_UTot()[ a ] );
+ }
+
+/*--------------------------------------------------------------------------*/
+/*------------------ METHODS FOR USING THE SCENARIOS -----------------------*/
+/*--------------------------------------------------------------------------*/
+
+MMCFBlock * MMCFScenarioSet::make_block( Index s , Block * father ) const
+{
+ if( ! f_base )
+  throw( std::logic_error( "MMCFScenarioSet::make_block: no base" ) );
+
+ if( ( s != Inf< Index >() ) && ( s >= get_NScenarios() ) )
+  throw( std::invalid_argument(
+			   "MMCFScenarioSet::make_block: invalid scenario" ) );
+
+ // the clone shares all the data of the base, and only makes a private
+ // copy of the rows of the deficits that the scenario changes
+ auto blk = f_base->clone( father );
+ if( s != Inf< Index >() )
+  apply( Inf< Index >() , s , *blk , eNoMod , eNoMod );
+
+ return( blk );
+
+ }  // end( MMCFScenarioSet::make_block )
+
+/*--------------------------------------------------------------------------*/
+
+void MMCFScenarioSet::apply( Index from , Index to , MMCFBlock & blk ,
+			     ModParam issueMod , ModParam issueAMod ) const
+{
+ if( from == to )
+  return;
+
+ const Index nS = get_NScenarios();
+ if( ( ( from != Inf< Index >() ) && ( from >= nS ) ) ||
+     ( ( to != Inf< Index >() ) && ( to >= nS ) ) )
+  throw( std::invalid_argument( "MMCFScenarioSet::apply: invalid scenario" ) );
+
+ // the ranges of the differences of the two scenarios (empty for the base)
+ auto bf = from == Inf< Index >() ? 0 : BDltBeg[ from ];
+ auto be = from == Inf< Index >() ? 0 : BDltBeg[ from + 1 ];
+ auto tf = to == Inf< Index >() ? 0 : BDltBeg[ to ];
+ auto te = to == Inf< Index >() ? 0 : BDltBeg[ to + 1 ];
+
+ // deficits: one chg_deficits() per commodity touched by either scenario,
+ // on the smallest Range covering all the nodes touched by either
+ while( ( bf < be ) || ( tf < te ) ) {
+  Index k = std::min( bf < be ? BDltK[ bf ] : Inf< Index >() ,
+		      tf < te ? BDltK[ tf ] : Inf< Index >() );
+
+  Index nmin = Inf< Index >();
+  Index nmax = 0;
+  auto fe = bf;
+  for( ; ( fe < be ) && ( BDltK[ fe ] == k ) ; ++fe ) {
+   nmin = std::min( nmin , BDltN[ fe ] );
+   nmax = std::max( nmax , BDltN[ fe ] );
+   }
+  auto ee = tf;
+  for( ; ( ee < te ) && ( BDltK[ ee ] == k ) ; ++ee ) {
+   nmin = std::min( nmin , BDltN[ ee ] );
+   nmax = std::max( nmax , BDltN[ ee ] );
+   }
+
+  // start from the current deficits, reset those of from to the base
+  // ones and then set those of to
+  const auto & Bb = f_base->get_B( k );
+  const auto & Bk = blk.get_B( k );
+  Vec_FNumber NB( Bk.begin() + nmin , Bk.begin() + nmax + 1 );
+  for( ; bf < fe ; ++bf )
+   NB[ BDltN[ bf ] - nmin ] = Bb[ BDltN[ bf ] ];
+  for( ; tf < ee ; ++tf )
+   NB[ BDltN[ tf ] - nmin ] = BDltV[ tf ];
+
+  blk.chg_deficits( k , NB.begin() , Range( nmin , nmax + 1 ) ,
+		    issueMod , issueAMod );
+  }
+
+ // mutual capacities: the same, in one call - - - - - - - - - - - - - - - -
+
+ bf = from == Inf< Index >() ? 0 : UDltBeg[ from ];
+ be = from == Inf< Index >() ? 0 : UDltBeg[ from + 1 ];
+ tf = to == Inf< Index >() ? 0 : UDltBeg[ to ];
+ te = to == Inf< Index >() ? 0 : UDltBeg[ to + 1 ];
+
+ if( ( bf == be ) && ( tf == te ) )
+  return;
+
+ Index amin = Inf< Index >();
+ Index amax = 0;
+ if( bf < be ) {
+  amin = UDltA[ bf ];
+  amax = UDltA[ be - 1 ];
+  }
+ if( tf < te ) {
+  amin = std::min( amin , UDltA[ tf ] );
+  amax = std::max( amax , UDltA[ te - 1 ] );
+  }
+
+ const auto & Ub = f_base->get_UTot();
+ const auto & Uk = blk.get_UTot();
+ Vec_FNumber NU( Uk.begin() + amin , Uk.begin() + amax + 1 );
+ for( ; bf < be ; ++bf )
+  NU[ UDltA[ bf ] - amin ] = Ub[ UDltA[ bf ] ];
+ for( ; tf < te ; ++tf )
+  NU[ UDltA[ tf ] - amin ] = UDltV[ tf ];
+
+ blk.chg_mutual_capacity( NU.begin() , Range( amin , amax + 1 ) ,
+			  issueMod , issueAMod );
+
+ }  // end( MMCFScenarioSet::apply )
+
+/*--------------------------------------------------------------------------*/
+/*--------------------- METHODS FOR SAVING THE SET -------------------------*/
+/*--------------------------------------------------------------------------*/
+
+void MMCFScenarioSet::serialize( netCDF::NcGroup & group ) const
+{
+ if( ! f_base )
+  throw( std::logic_error( "MMCFScenarioSet::serialize: no base" ) );
+
+ auto base = group.addGroup( "Base" );
+ f_base->serialize( base );
+
+ netCDF::NcDim ns = group.addDim( "NScenarios" , get_NScenarios() + 1 );
+
+ ( group.addVar( "BDltBeg" , netCDF::NcUint64() , ns ) ).putVar(
+							   BDltBeg.data() );
+ ( group.addVar( "UDltBeg" , netCDF::NcUint64() , ns ) ).putVar(
+							   UDltBeg.data() );
+
+ if( ! BDltK.empty() ) {
+  netCDF::NcDim nb = group.addDim( "NBDlt" , BDltK.size() );
+  ( group.addVar( "BDltK" , netCDF::NcUint64() , nb ) ).putVar(
+							     BDltK.data() );
+  ( group.addVar( "BDltN" , netCDF::NcUint64() , nb ) ).putVar(
+							     BDltN.data() );
+  ( group.addVar( "BDltV" , netCDF::NcDouble() , nb ) ).putVar(
+							     BDltV.data() );
+  }
+
+ if( ! UDltA.empty() ) {
+  netCDF::NcDim nu = group.addDim( "NUDlt" , UDltA.size() );
+  ( group.addVar( "UDltA" , netCDF::NcUint64() , nu ) ).putVar(
+							     UDltA.data() );
+  ( group.addVar( "UDltV" , netCDF::NcDouble() , nu ) ).putVar(
+							     UDltV.data() );
+  }
+ }  // end( MMCFScenarioSet::serialize )
+
+/*--------------------------------------------------------------------------*/
+
+void MMCFScenarioSet::deserialize( const netCDF::NcGroup & group )
+{
+ auto base = group.getGroup( "Base" );
+ if( base.isNull() )
+  throw( std::logic_error( "Base group is required" ) );
+
+ auto blk = new MMCFBlock();
+ try {
+  blk->deserialize( base );
+  }
+ catch( ... ) {
+  delete blk;
+  throw;
+  }
+
+ set_base( blk );
+
+ auto ns = group.getDim( "NScenarios" );
+ if( ns.isNull() )
+  return;
+
+ BDltBeg.resize( ns.getSize() );
+ UDltBeg.resize( ns.getSize() );
+
+ auto bb = group.getVar( "BDltBeg" );
+ auto ub = group.getVar( "UDltBeg" );
+ if( bb.isNull() || ub.isNull() )
+  throw( std::logic_error( "Scenario starts not found" ) );
+
+ bb.getVar( BDltBeg.data() );
+ ub.getVar( UDltBeg.data() );
+
+ if( BDltBeg.empty() || UDltBeg.empty() || BDltBeg.front() ||
+     UDltBeg.front() ||
+     ( ! std::is_sorted( BDltBeg.begin() , BDltBeg.end() ) ) ||
+     ( ! std::is_sorted( UDltBeg.begin() , UDltBeg.end() ) ) )
+  throw( std::logic_error( "Invalid scenario starts" ) );
+
+ auto nb = group.getDim( "NBDlt" );
+ Index NB = nb.isNull() ? 0 : nb.getSize();
+ if( BDltBeg.back() != NB )
+  throw( std::logic_error( "Invalid scenario starts" ) );
+
+ if( NB ) {
+  auto bk = group.getVar( "BDltK" );
+  auto bn = group.getVar( "BDltN" );
+  auto bv = group.getVar( "BDltV" );
+  if( bk.isNull() || bn.isNull() || bv.isNull() )
+   throw( std::logic_error( "Deficit differences not found" ) );
+
+  BDltK.resize( NB );
+  BDltN.resize( NB );
+  BDltV.resize( NB );
+  bk.getVar( BDltK.data() );
+  bn.getVar( BDltN.data() );
+  bv.getVar( BDltV.data() );
+
+  // the same invariants that add_scenario() enforces: valid indices,
+  // strictly increasing ( k , n ) within each scenario [see find_B()]
+  const Index nn = f_base->get_NNodes();
+  const Index nc = f_base->get_NComm();
+  for( Index s = 0 ; s + 1 < BDltBeg.size() ; ++s )
+   for( Index t = BDltBeg[ s ] ; t < BDltBeg[ s + 1 ] ; ++t ) {
+    if( ( BDltK[ t ] >= nc ) || ( BDltN[ t ] >= nn ) )
+     throw( std::logic_error( "Invalid deficit difference" ) );
+    if( ( t > BDltBeg[ s ] ) &&
+	( ( BDltK[ t ] < BDltK[ t - 1 ] ) ||
+	  ( ( BDltK[ t ] == BDltK[ t - 1 ] ) &&
+	    ( BDltN[ t ] <= BDltN[ t - 1 ] ) ) ) )
+     throw( std::logic_error( "Unsorted deficit differences" ) );
+    }
+  }
+
+ auto nu = group.getDim( "NUDlt" );
+ Index NU = nu.isNull() ? 0 : nu.getSize();
+ if( UDltBeg.back() != NU )
+  throw( std::logic_error( "Invalid scenario starts" ) );
+
+ if( NU ) {
+  auto ua = group.getVar( "UDltA" );
+  auto uv = group.getVar( "UDltV" );
+  if( ua.isNull() || uv.isNull() )
+   throw( std::logic_error( "Mutual capacity differences not found" ) );
+
+  UDltA.resize( NU );
+  UDltV.resize( NU );
+  ua.getVar( UDltA.data() );
+  uv.getVar( UDltV.data() );
+
+  // valid arcs, strictly increasing within each scenario [see find_U()]
+  const Index na = f_base->get_NArcs();
+  for( Index s = 0 ; s + 1 < UDltBeg.size() ; ++s )
+   for( Index t = UDltBeg[ s ] ; t < UDltBeg[ s + 1 ] ; ++t ) {
+    if( UDltA[ t ] >= na )
+     throw( std::logic_error( "Invalid mutual capacity difference" ) );
+    if( ( t > UDltBeg[ s ] ) && ( UDltA[ t ] <= UDltA[ t - 1 ] ) )
+     throw( std::logic_error( "Unsorted mutual capacity differences" ) );
+    }
+  }
+ }  // end( MMCFScenarioSet::deserialize )
+
+/*--------------------------------------------------------------------------*/
+/*--------------------------- PROTECTED METHODS ----------------------------*/
+/*--------------------------------------------------------------------------*/
+
+Index MMCFScenarioSet::find_B( Index s , Index k , Index n ) const
+{
+ if( s == Inf< Index >() )
+  return( Inf< Index >() );
+
+ auto b = BDltK.begin();
+ Index lo = BDltBeg[ s ];
+ Index hi = BDltBeg[ s + 1 ];
+ while( lo < hi ) {
+  Index mid = ( lo + hi ) / 2;
+  if( ( b[ mid ] < k ) || ( ( b[ mid ] == k ) && ( BDltN[ mid ] < n ) ) )
+   lo = mid + 1;
+  else
+   hi = mid;
+  }
+
+ return( ( lo < BDltBeg[ s + 1 ] ) && ( b[ lo ] == k ) && ( BDltN[ lo ] == n )
+	 ? lo : Inf< Index >() );
+ }
+
+/*--------------------------------------------------------------------------*/
+
+Index MMCFScenarioSet::find_U( Index s , Index a ) const
+{
+ if( s == Inf< Index >() )
+  return( Inf< Index >() );
+
+ auto beg = UDltA.begin() + UDltBeg[ s ];
+ auto end = UDltA.begin() + UDltBeg[ s + 1 ];
+ auto it = std::lower_bound( beg , end , a );
+
+ return( ( it != end ) && ( *it == a ) ? Index( it - UDltA.begin() )
+	                               : Inf< Index >() );
+ }
+
+/*--------------------------------------------------------------------------*/
+/*--------------------- End File MMCFScenarioSet.cpp -----------------------*/
+/*--------------------------------------------------------------------------*/
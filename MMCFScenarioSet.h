@@ -0,0 +1,280 @@
+/*--------------------------------------------------------------------------*/
+/*------------------------- File MMCFScenarioSet.h -------------------------*/
+/*--------------------------------------------------------------------------*/
+/** @file
+ * Header file for the class MMCFScenarioSet, a container of demand (and
+ * mutual capacity) scenarios for a Multicommodity Min Cost Flow problem
+ * [see MMCFBlock.h], all sharing the same graph, costs and individual
+ * capacities.
+ *
+ * \author Antonio Frangioni \n
+ *         Dipartimento di Informatica \n
+ *         Universita' di Pisa \n
+ *
+ * \author Enrico Gorgone \n
+ *         Dipartimento di Informatica \n
+ *         Universita' di Pisa \n
+ *
+ * \author Francesco Demelas \n
+ *         Laboratoire d'Informatique de Paris Nord \n
+ *         Universite' Sorbonne Paris Nord \n
+ *
+ * Copyright &copy by Antonio Frangioni, Enrico Gorgone, Francesco Demelas
+ */
+/*--------------------------------------------------------------------------*/
+/*----------------------------- DEFINITIONS --------------------------------*/
+/*--------------------------------------------------------------------------*/
+
+#ifndef __MMCFScenarioSet
+ #define __MMCFScenarioSet  /* self-identification: #endif at the end */
+
+/*--------------------------------------------------------------------------*/
+/*------------------------------ INCLUDES ----------------------------------*/
+/*--------------------------------------------------------------------------*/
+
+#include "MMCFBlock.h"
+
+/*--------------------------------------------------------------------------*/
+/*--------------------------- NAMESPACE ------------------------------------*/
+/*--------------------------------------------------------------------------*/
+
+/// namespace for the Structured Modeling System++ (SMS++)
+namespace SMSpp_di_unipi_it
+{
+/*--------------------------------------------------------------------------*/
+/*------------------------------- CLASSES ----------------------------------*/
+/*--------------------------------------------------------------------------*/
+/** @defgroup MMCFScenarioSet_CLASSES Classes in MMCFScenarioSet.h
+ *  @{ */
+
+/*--------------------------------------------------------------------------*/
+/*------------------------- CLASS MMCFScenarioSet --------------------------*/
+/*--------------------------------------------------------------------------*/
+/*--------------------------- GENERAL NOTES --------------------------------*/
+/*--------------------------------------------------------------------------*/
+/// a set of demand scenarios sharing the same MMCF instance
+/** The MMCFScenarioSet class holds a "base" MMCFBlock, whose data (graph,
+ * costs, capacities, deficits, mutual capacities) is stored only once, and
+ * a set of scenarios, each one described by the (sparse) differences of its
+ * node deficits B and (optionally) mutual capacities UTot w.r.t. those of
+ * the base MMCFBlock. Thus, the memory taken by the set grows with the size
+ * of the differences and not with the number of scenarios times the size of
+ * the instance.
+ *
+ * A scenario can be turned into an actual MMCFBlock either by constructing
+ * a new one [see make_block()], or by changing one that currently is in
+ * another scenario [see apply()]; the latter only changes the deficits and
+ * mutual capacities that differ between the two scenarios, through the
+ * in-place methods of MMCFBlock, so that any attached Solver can reoptimize.
+ * The whole set can be (de)serialized to (from) a single netCDF group. */
+
+class MMCFScenarioSet
+{
+/*--------------------------------------------------------------------------*/
+/*----------------------- PUBLIC PART OF THE CLASS -------------------------*/
+/*--------------------------------------------------------------------------*/
+
+ public:
+
+/*--------------------------------------------------------------------------*/
+/*---------------------------- PUBLIC TYPES --------------------------------*/
+/*--------------------------------------------------------------------------*/
+
+ using Index = Block::Index;
+ using Subset = Block::Subset;
+ using Range = Block::Range;
+
+ /// the deficit of commodity k at node n (0-based) is b in the scenario
+ struct BDelta {
+  Index k;    ///< the commodity
+  Index n;    ///< the node (0-based)
+  FNumber b;  ///< the deficit
+  };
+
+ /// the mutual capacity of arc a is u in the scenario
+ struct UDelta {
+  Index a;    ///< the arc
+  FNumber u;  ///< the mutual capacity
+  };
+
+/*--------------------------------------------------------------------------*/
+/*--------------------- PUBLIC METHODS OF THE CLASS ------------------------*/
+/*--------------------------------------------------------------------------*/
+/*---------------------------- CONSTRUCTOR ---------------------------------*/
+/*--------------------------------------------------------------------------*/
+/** @name Constructor and Destructor
+ *  @{ */
+
+ /// constructor: takes the base MMCFBlock, of which it takes ownership
+
+ explicit MMCFScenarioSet( MMCFBlock * base = nullptr ) : f_base( base ) {
+  BDltBeg.push_back( 0 );
+  UDltBeg.push_back( 0 );
+  }
+
+ MMCFScenarioSet( const MMCFScenarioSet & ) = delete;
+
+ MMCFScenarioSet & operator=( const MMCFScenarioSet & ) = delete;
+
+/*--------------------------------------------------------------------------*/
+ /// destructor: deletes the base MMCFBlock
+
+ virtual ~MMCFScenarioSet() { delete f_base; }
+
+/*@} -----------------------------------------------------------------------*/
+/*--------------------- Methods for building the set -----------------------*/
+/*--------------------------------------------------------------------------*/
+/** @name Methods for building the set
+ *  @{ */
+
+ /// set the base MMCFBlock, taking ownership of it: all scenarios are lost
+
+ void set_base( MMCFBlock * base );
+
+/*--------------------------------------------------------------------------*/
+ /// add a scenario given by its differences w.r.t. the base MMCFBlock
+ /** Add a scenario given by the differences db of its deficits and du of
+  * its mutual capacities w.r.t. these of the base MMCFBlock; the entries
+  * can be given in any order, the last one winning if the same deficit
+  * (mutual capacity) appears more than once, and these that do not differ
+  * from the base are dropped. Returns the index of the new scenario. */
+
+ Index add_scenario( std::vector< BDelta > && db ,
+		     std::vector< UDelta > && du = {} );
+
+/*--------------------------------------------------------------------------*/
+ /// add a scenario given by a MMCFBlock with the same instance as the base
+ /** Add the scenario whose deficits and mutual capacities are those of blk,
+  * which must have the same dimensions as the base MMCFBlock (and is
+  * assumed to have the same graph, costs and individual capacities).
+  * Returns the index of the new scenario. */
+
+ Index add_scenario( const MMCFBlock & blk );
+
+/*@} -----------------------------------------------------------------------*/
+/*--------------------- Methods for reading the set ------------------------*/
+/*--------------------------------------------------------------------------*/
+/** @name Methods for reading the set
+ *  @{ */
+
+ /// the base MMCFBlock
+
+ const MMCFBlock * get_base( void ) const { return( f_base ); }
+
+/*--------------------------------------------------------------------------*/
+ /// the number of scenarios
+
+ Index get_NScenarios( void ) const { return( BDltBeg.size() - 1 ); }
+
+/*--------------------------------------------------------------------------*/
+ /// the deficit of commodity k at node n (0-based) in scenario s
+ /** The deficit of commodity k at node n (0-based) in scenario s; s ==
+  * Inf< Index >() means the base MMCFBlock. */
+
+ FNumber get_B( Index s , Index k , Index n ) const;
+
+/*--------------------------------------------------------------------------*/
+ /// the mutual capacity of arc a in scenario s (Inf< Index >() is the base)
+
+ FNumber get_UTot( Index s , Index a ) const;
+
+/*@} -----------------------------------------------------------------------*/
+/*------------------- Methods for using the scenarios ----------------------*/
+/*--------------------------------------------------------------------------*/
+/** @name Methods for using the scenarios
+ *  @{ */
+
+ /// construct a new MMCFBlock for scenario s
+ /** Construct a new MMCFBlock (with the given father, if any) for scenario
+  * s, i.e., with the data of the base MMCFBlock as changed by s; s ==
+  * Inf< Index >() means the base MMCFBlock itself. The new MMCFBlock is a
+  * clone of the base one [see MMCFBlock::clone()], and therefore shares
+  * with it all the data that the scenario does not change; it belongs to
+  * the caller. */
+
+ MMCFBlock * make_block( Index s , Block * father = nullptr ) const;
+
+/*--------------------------------------------------------------------------*/
+ /// change blk, which is in scenario from, into scenario to
+ /** Change blk, which currently has the data of scenario from, into
+  * scenario to (either can be Inf< Index >(), meaning the base MMCFBlock).
+  * Only the deficits and mutual capacities that are changed by either
+  * scenario are touched, by means of MMCFBlock::chg_deficits() and
+  * MMCFBlock::chg_mutual_capacity() with the given issueMod and
+  * issueAMod; hence, the abstract representation of blk (if any) is
+  * updated in place, and any Solver attached to it can reoptimize. */
+
+ void apply( Index from , Index to , MMCFBlock & blk ,
+	     ModParam issueMod = eModBlck ,
+	     ModParam issueAMod = eModBlck ) const;
+
+/*@} -----------------------------------------------------------------------*/
+/*---------------------- Methods for saving the set ------------------------*/
+/*--------------------------------------------------------------------------*/
+/** @name Methods for saving the set
+ *  @{ */
+
+ /// serialize the set into the netCDF group
+ /** Serialize the set into the netCDF group: the base MMCFBlock goes into
+  * the sub-group "Base", and the differences of all the scenarios into the
+  * variables BDltBeg, BDltK, BDltN, BDltV (deficits) and UDltBeg, UDltA,
+  * UDltV (mutual capacities), where the differences of scenario s are the
+  * entries in [ *DltBeg[ s ] , *DltBeg[ s + 1 ] ). */
+
+ void serialize( netCDF::NcGroup & group ) const;
+
+/*--------------------------------------------------------------------------*/
+ /// deserialize the set out of the netCDF group [see serialize()]
+
+ void deserialize( const netCDF::NcGroup & group );
+
+/** @} ---------------------------------------------------------------------*/
+/*-------------------- PROTECTED PART OF THE CLASS -------------------------*/
+/*--------------------------------------------------------------------------*/
+
+ protected:
+
+/*--------------------------------------------------------------------------*/
+/*-------------------------- PROTECTED METHODS -----------------------------*/
+/*--------------------------------------------------------------------------*/
+
+ /// position of the difference of ( k , n ) in scenario s, Inf if none
+ Index find_B( Index s , Index k , Index n ) const;
+
+ /// position of the difference of arc a in scenario s, Inf if none
+ Index find_U( Index s , Index a ) const;
+
+/*--------------------------------------------------------------------------*/
+/*--------------------------- PROTECTED FIELDS -----------------------------*/
+/*--------------------------------------------------------------------------*/
+
+ MMCFBlock * f_base;  ///< the base MMCFBlock
+
+ Subset BDltBeg;      ///< start of the deficit differences of each scenario
+ Subset BDltK;        ///< commodity of each deficit difference
+ Subset BDltN;        ///< node of each deficit difference
+ Vec_FNumber BDltV;   ///< value of each deficit difference
+
+ Subset UDltBeg;      ///< start of the mutual capacity diffs of each scenario
+ Subset UDltA;        ///< arc of each mutual capacity difference
+ Vec_FNumber UDltV;   ///< value of each mutual capacity difference
+
+/*--------------------------------------------------------------------------*/
+
+ };  // end( class( MMCFScenarioSet ) )
+
+/*--------------------------------------------------------------------------*/
+
+/*@}  end( group( MMCFScenarioSet_CLASSES ) ) -----------------------------*/
+/*--------------------------------------------------------------------------*/
+
+ }  // end( namespace SMSpp_di_unipi_it )
+
+/*--------------------------------------------------------------------------*/
+/*--------------------------------------------------------------------------*/
+
+#endif  /* MMCFScenarioSet.h included */
+
+/*--------------------------------------------------------------------------*/
+/*-------------------- End File MMCFScenarioSet.h --------------------------*/
+/*--------------------------------------------------------------------------*/
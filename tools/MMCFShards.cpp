@@ -0,0 +1,161 @@
+/*--------------------------------------------------------------------------*/
+/*------------------------- File MMCFShards.cpp ----------------------------*/
+/*--------------------------------------------------------------------------*/
+/** @file
+ * Round-trip check of the sharded instance files of MMCFBlock.
+ *
+ * Loads an instance, writes it with MMCFBlock::serialize_shards() and then
+ * starts one process per shard, each one loading its shard with
+ * MMCFBlock::deserialize_shard() (as a worker of a decomposition would)
+ * and checking it against the original instance: the topology, the mutual
+ * capacities and the fixed costs must be those of the whole instance, the
+ * commodities must be the expected contiguous range of these of the whole
+ * instance, with the same costs, capacities and deficits, and get_flow()
+ * must take the global commodity indices. The exit status is 0 if all the
+ * shards pass the check, 1 otherwise.
+ *
+ * Usage: MMCFShards <instance> <nshards> [ <prefix> [ <format> ] ]
+ *
+ * where the instance is read by MMCFBlock::load( instance , format ) and
+ * the sharded files are written with the given prefix ("shard_" if none).
+ *
+ * \author Antonio Frangioni \n
+ *         Dipartimento di Informatica \n
+ *         Universita' di Pisa \n
+ *
+ * Copyright &copy by Antonio Frangioni
+ */
+/*--------------------------------------------------------------------------*/
+/*------------------------------ INCLUDES ----------------------------------*/
+/*--------------------------------------------------------------------------*/
+
+#include "MMCFBlock.h"
+
+#include <iostream>
+
+#include <sys/wait.h>
+
+#include <unistd.h>
+
+/*--------------------------------------------------------------------------*/
+/*------------------------- NAMESPACE AND USING ----------------------------*/
+/*--------------------------------------------------------------------------*/
+
+using namespace SMSpp_di_unipi_it;
+
+using Index = Block::Index;
+
+/*--------------------------------------------------------------------------*/
+/*------------------------------- FUNCTIONS --------------------------------*/
+/*--------------------------------------------------------------------------*/
+
+static bool check( bool cond , Index h , const std::string & what )
+{
+ if( ! cond )
+  std::cerr << "shard " << h << ": wrong " << what << std::endl;
+ return( cond );
+ }
+
+/*--------------------------------------------------------------------------*/
+// load shard h of nshards and check it against the whole instance mmcf
+
+static bool check_shard( const MMCFBlock & mmcf , const std::string & prefix ,
+			 Index h , Index nshards )
+{
+ MMCFBlock shard;
+ {
+  netCDF::NcFile topo( prefix + "topology.nc" , netCDF::NcFile::read );
+  netCDF::NcFile data( prefix + "shard" + std::to_string( h ) + ".nc" ,
+		       netCDF::NcFile::read );
+  shard.deserialize_shard( topo , data );
+  }
+
+ const Index NComm = mmcf.get_NComm();
+ const Index first = ( NComm * h ) / nshards;
+ const Index last = ( NComm * ( h + 1 ) ) / nshards;
+
+ bool ok = check( shard.get_NNodes() == mmcf.get_NNodes() , h , "NNodes" );
+ ok &= check( shard.get_NArcs() == mmcf.get_NArcs() , h , "NArcs" );
+ ok &= check( shard.get_NCommGlobal() == NComm , h , "NCommGlobal" );
+ ok &= check( shard.get_FirstComm() == first , h , "FirstComm" );
+ ok &= check( shard.get_NComm() == last - first , h , "NComm" );
+ if( ! ok )
+  return( false );
+
+ ok &= check( shard.get_Startn() == mmcf.get_Startn() , h , "Startn" );
+ ok &= check( shard.get_Endn() == mmcf.get_Endn() , h , "Endn" );
+ ok &= check( shard.get_UTot() == mmcf.get_UTot() , h , "UTot" );
+ ok &= check( shard.get_F() == mmcf.get_F() , h , "F" );
+
+ for( Index k = 0 ; k < shard.get_NComm() ; ++k ) {
+  const std::string c = " of commodity " + std::to_string( first + k );
+  ok &= check( shard.get_C( k ) == mmcf.get_C( first + k ) , h , "C" + c );
+  ok &= check( shard.get_U( k ) == mmcf.get_U( first + k ) , h , "U" + c );
+  ok &= check( shard.get_B( k ) == mmcf.get_B( first + k ) , h , "B" + c );
+  }
+
+ // no formulation, hence no flow; the indices out of the shard are valid
+ for( Index gk = 0 ; gk <= NComm ; ++gk )
+  ok &= check( shard.get_flow( gk , 0 ) == 0 , h , "get_flow()" );
+
+ return( ok );
+ }
+
+/*--------------------------------------------------------------------------*/
+/*--------------------------------- MAIN -----------------------------------*/
+/*--------------------------------------------------------------------------*/
+
+int main( int argc , char **argv )
+{
+ if( argc < 3 ) {
+  std::cerr << "Usage: " << argv[ 0 ]
+	    << " <instance> <nshards> [ <prefix> [ <format> ] ]" << std::endl;
+  return( 1 );
+  }
+
+ const Index nshards = std::stoul( argv[ 2 ] );
+ const std::string prefix = argc > 3 ? argv[ 3 ] : "shard_";
+ const char frmt = argc > 4 ? argv[ 4 ][ 0 ] : 0;
+
+ MMCFBlock mmcf;
+ try {
+  mmcf.load( argv[ 1 ] , frmt );
+  mmcf.serialize_shards( prefix , nshards );
+  }
+ catch( std::exception & e ) {
+  std::cerr << e.what() << std::endl;
+  return( 1 );
+  }
+
+ // one worker process per shard, as in a decomposition
+ std::vector< pid_t > pids( nshards );
+ for( Index h = 0 ; h < nshards ; ++h )
+  if( ! ( pids[ h ] = fork() ) ) {
+   bool ok = false;
+   try {
+    ok = check_shard( mmcf , prefix , h , nshards );
+    }
+   catch( std::exception & e ) {
+    std::cerr << "shard " << h << ": " << e.what() << std::endl;
+    }
+   _exit( ok ? 0 : 1 );
+   }
+
+ bool ok = true;
+ for( Index h = 0 ; h < nshards ; ++h ) {
+  int status = 1;
+  if( ( pids[ h ] < 0 ) || ( waitpid( pids[ h ] , & status , 0 ) < 0 ) ||
+      ( ! WIFEXITED( status ) ) || WEXITSTATUS( status ) ) {
+   std::cerr << "shard " << h << ": FAILED" << std::endl;
+   ok = false;
+   }
+  }
+
+ std::cout << mmcf.get_NComm() << " commodities in " << nshards
+	   << " shards: " << ( ok ? "OK" : "FAILED" ) << std::endl;
+ return( ok ? 0 : 1 );
+ }
+
+/*--------------------------------------------------------------------------*/
+/*----------------------- End File MMCFShards.cpp --------------------------*/
+/*--------------------------------------------------------------------------*/